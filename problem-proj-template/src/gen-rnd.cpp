@@ -50,18 +50,24 @@ typedef pair<int64, int64> pii64;
 int main(int argc, char* argv[])
 {
 	using namespace problib;
-#ifdef PROBLEM_DEV
-	freopen("input.txt", "w", stdout);
-	args.initRegisterGen(argc, argv, "n=[1,100]");
-#else
-	args.initRegisterGen(argc, argv);
-#endif
+	const auto arg_n = arg<int64>("n", "[1,1e18]");
 
-	auto arg_n = args["n"].ranges<int64>();
+	auto generate = [&]
+	{
+		io::writer out;
 
-	int64 n = arg_n.get_rnd();
-	cout << n << endl;
+		int64 n = arg_n.get_rnd();
+		out << n << '\n';
+	};
 
+#ifdef PROBLEM_DEV
+	freopen("input.txt", "w", stdout);
+	// the ranges of range literals are parsed at compile time
+	args.initRegisterGen(argc, argv, "n", parse_range_literal<int64>("[1,100]"));
+	generate();
 	return 0;
+#else
+	// gen-rnd --script=gen-script.txt [--jobs=0] writes all tests of gen-rnd from the script
+	return args.run(argc, argv, generate);
+#endif
 }
-
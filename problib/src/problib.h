@@ -3,15 +3,52 @@
 #define _PROBLIB_H_VER_ "0.10"
 
 #include <map>
+#include <limits>
+#include <climits>
+#include <memory>
+#include <charconv>
 #include <string>
 #include <string_view>
 #include <type_traits>
 #include <sstream>
+#include <locale>
 #include <cctype>
 #include <cassert>
+#include <cmath>
+#include <cstring>
+#include <cstdio>
+#include <cstdlib>
+#include <cerrno>
+#include <iterator>
+#include <algorithm>
 #include <vector>
 #include <numeric>
+#include <utility>
+#include <tuple>
+#include <functional>
 #include <stdexcept>
+#if !defined(PROBLIB_NO_SIMD) && (defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2))
+#define PROBLIB_SIMD_SSE2
+#include <emmintrin.h>
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define PROBLIB_SIMD_AVX2
+#include <immintrin.h>
+#endif
+#endif
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+#ifdef _WIN32
+#include <io.h>
+#include <fcntl.h>
+#include <process.h>
+#include <thread>
+#else
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/wait.h>
+#include <atomic>
+#endif
 #undef max
 #undef min
 
@@ -19,30 +56,185 @@ namespace problib
 {
 	namespace str
 	{
-		template<typename T>
-		const std::string to_string(const T& value)
+		namespace impl
 		{
-			std::ostringstream oss;
-			oss << value;
-			return oss.str();
-		}
+			template<typename T>
+			constexpr bool is_int128_v =
+#ifdef __SIZEOF_INT128__
+				std::is_same_v<std::remove_cv_t<T>, __int128> || std::is_same_v<std::remove_cv_t<T>, unsigned __int128>;
+#else
+				false;
+#endif
 
-		template<typename T>
-		bool try_parse(const std::string& s, T& val)
-		{
-			auto iss = std::istringstream(s);
-			iss >> val;
-			return !!iss;
+			// std::is_signed_v is false for __int128 in strict standard modes
+			template<typename T>
+			constexpr bool is_signed_number_v = std::is_signed_v<T>
+#ifdef __SIZEOF_INT128__
+				|| std::is_same_v<std::remove_cv_t<T>, __int128>
+#endif
+				;
+
+			// character-like types are read by streams as single characters, so they keep the stream path.
+			template<typename T>
+			constexpr bool is_char_like_v =
+				std::is_same_v<T, bool> || std::is_same_v<T, char> || std::is_same_v<T, signed char> ||
+				std::is_same_v<T, unsigned char> || std::is_same_v<T, wchar_t> ||
+				std::is_same_v<T, char16_t> || std::is_same_v<T, char32_t>;
+
+			template<typename T>
+			constexpr bool is_fast_integral_v = std::is_integral_v<T> && !is_char_like_v<T> && !is_int128_v<T>;
+
+			template<typename T>
+			constexpr bool is_fast_number_v = is_fast_integral_v<T> || std::is_floating_point_v<T> || is_int128_v<T>;
+
+			bool is_parse_space(char c)
+			{
+				return c == ' ' || c == '\t' || c == '\n' || c == '\r' || c == '\v' || c == '\f';
+			}
+
+			// strips surrounding whitespace and a leading '+' the way stream extraction tolerates them.
+			bool prepare_number(std::string_view& s, bool allowPlus)
+			{
+				while (!s.empty() && is_parse_space(s.front())) s.remove_prefix(1);
+				while (!s.empty() && is_parse_space(s.back())) s.remove_suffix(1);
+				if (allowPlus && s.size() > 1 && s.front() == '+' && s[1] != '-') s.remove_prefix(1);
+				return !s.empty();
+			}
+
+			// integers written like 1e5 or 2.5e3, s is prepared.
+			// accepted only if the value is an exact integer representable in T.
+			template<typename T>
+			bool exponent_integer_parse(std::string_view s, T& val)
+			{
+				size_t e = s.find_first_of("eE");
+				if (e == std::string_view::npos) return false;
+				std::string_view mantissa = s.substr(0, e);
+				std::string_view exponentPart = s.substr(e + 1);
+
+				bool negative = !mantissa.empty() && mantissa.front() == '-';
+				if (negative) mantissa.remove_prefix(1);
+				if (!exponentPart.empty() && exponentPart.front() == '+') exponentPart.remove_prefix(1);
+				int exponent;
+				auto res = std::from_chars(exponentPart.data(), exponentPart.data() + exponentPart.size(), exponent);
+				if (exponentPart.empty() || res.ec != std::errc() || res.ptr != exponentPart.data() + exponentPart.size()) return false;
+
+				using unsigned_type = std::make_unsigned_t<T>;
+				const unsigned long long limit = static_cast<unsigned long long>(std::numeric_limits<T>::max()) + (negative && std::is_signed_v<T> ? 1 : 0);
+				unsigned long long value = 0;
+				bool point = false, digits = false;
+				long long scale = exponent;
+				for (char c : mantissa)
+				{
+					if (c == '.' && !point)
+					{
+						point = true;
+						continue;
+					}
+					if (c < '0' || c > '9') return false;
+					unsigned digit = unsigned(c - '0');
+					if (value > (limit - digit) / 10) return false;
+					value = value * 10 + digit;
+					digits = true;
+					if (point) --scale;
+				}
+				if (!digits || (negative && !std::is_signed_v<T> && value)) return false;
+				for (; scale < 0; ++scale)
+				{
+					if (value % 10) return false;
+					value /= 10;
+				}
+				for (; scale > 0 && value; --scale)
+				{
+					if (value > limit / 10) return false;
+					value *= 10;
+				}
+				val = negative ? T(unsigned_type(0) - unsigned_type(value)) : T(value);
+				return true;
+			}
+
+			template<typename T>
+			bool from_chars_parse(std::string_view s, T& val)
+			{
+				if (!prepare_number(s, true)) return false;
+				T result;
+				auto res = std::from_chars(s.data(), s.data() + s.size(), result);
+				if (res.ec != std::errc() || res.ptr != s.data() + s.size())
+				{
+					if constexpr (std::is_integral_v<T>) return exponent_integer_parse(s, val);
+					else return false;
+				}
+				val = result;
+				return true;
+			}
+
+#ifdef __SIZEOF_INT128__
+			// std::from_chars has no 128-bit overloads, so those are parsed by hand.
+			template<typename T>
+			bool int128_parse(std::string_view s, T& val)
+			{
+				if (!prepare_number(s, true)) return false;
+				bool negative = false;
+				if (s.front() == '-')
+				{
+					if (!is_signed_number_v<T>) return false;
+					negative = true;
+					s.remove_prefix(1);
+					if (s.empty()) return false;
+				}
+
+				using unsigned_type = unsigned __int128;
+				const unsigned_type unsignedMax = ~unsigned_type(0);
+				const unsigned_type limit = !is_signed_number_v<T>
+					? unsignedMax
+					: (unsignedMax >> 1) + (negative ? 1 : 0);
+
+				unsigned_type result = 0;
+				for (char c : s)
+				{
+					if (c < '0' || c > '9') return false;
+					unsigned digit = unsigned(c - '0');
+					if (result > (limit - digit) / 10) return false;
+					result = result * 10 + digit;
+				}
+				val = negative ? T(-result) : T(result);
+				return true;
+			}
+#endif
+
+			template<typename T>
+			bool stream_parse(std::string_view s, T& val)
+			{
+				auto iss = std::istringstream(std::string(s));
+				iss >> val;
+				return !!iss;
+			}
 		}
 
+		// parses whole s (surrounding whitespace allowed) into val.
+		// integers and floating values are parsed by std::from_chars without allocations,
+		// other types are read from a stream.
 		template<typename T>
 		bool try_parse(std::string_view s, T& val)
 		{
-			return try_parse(std::string(s), val);
+#ifdef __SIZEOF_INT128__
+			if constexpr (impl::is_int128_v<T>)
+			{
+				return impl::int128_parse(s, val);
+			}
+			else
+#endif
+			if constexpr (impl::is_fast_number_v<T>)
+			{
+				return impl::from_chars_parse(s, val);
+			}
+			else
+			{
+				return impl::stream_parse(s, val);
+			}
 		}
 
 		template<typename T>
-		T parse(const std::string& s)
+		T parse(std::string_view s)
 		{
 			T val;
 			if (!try_parse(s, val))
@@ -52,407 +244,3907 @@ namespace problib
 			return val;
 		}
 
-		template<typename T>
-		T parse(std::string_view s)
+
+
+		namespace impl
 		{
-			return parse<T>(std::string(s));
-		}
+			// enough for any integer up to 128 bits and for floating values in general/scientific format
+			constexpr size_t max_number_length = 64;
 
+			constexpr char digit_pairs[] =
+				"00010203040506070809"
+				"10111213141516171819"
+				"20212223242526272829"
+				"30313233343536373839"
+				"40414243444546474849"
+				"50515253545556575859"
+				"60616263646566676869"
+				"70717273747576777879"
+				"80818283848586878889"
+				"90919293949596979899";
 
+			template<typename U>
+			int decimal_length(U value)
+			{
+				int length = 1;
+				for (;;)
+				{
+					if (value < 10) return length;
+					if (value < 100) return length + 1;
+					if (value < 1000) return length + 2;
+					if (value < 10000) return length + 3;
+					value /= 10000;
+					length += 4;
+				}
+			}
 
-		std::vector<std::string_view> split(
-			std::string_view s,
-			std::string_view splitter,
-			bool includeEmpty = false
-		)
-		{
-			std::vector<std::string_view> res;
-			assert(!splitter.empty());
-			if (s.size() < splitter.size()) return res;
+			// writes exactly length digits of value ending at last, two digits per step.
+			template<typename U>
+			void write_digits(char* last, U value, int length)
+			{
+				char* p = last;
+				while (length >= 2)
+				{
+					p -= 2;
+					std::memcpy(p, digit_pairs + (value % 100) * 2, 2);
+					value /= 100;
+					length -= 2;
+				}
+				if (length) *--p = char('0' + value);
+			}
 
-			size_t from = 0;
-			for (size_t i = 0; i < s.size() - splitter.size() + 1; ++i)
+			char* write_unsigned(char* out, unsigned long long value)
 			{
-				if (s.substr(i, splitter.size()) == splitter)
+				// 32-bit division by constant is considerably cheaper
+				if (value <= 0xFFFFFFFFull)
 				{
-					if (from < i || includeEmpty)
-					{
-						res.push_back(s.substr(from, i - from));
-					}
-					i += splitter.size() - 1;
-					from = i + 1;
+					unsigned value32 = static_cast<unsigned>(value);
+					int length = decimal_length(value32);
+					write_digits(out + length, value32, length);
+					return out + length;
 				}
+				int length = decimal_length(value);
+				write_digits(out + length, value, length);
+				return out + length;
 			}
-			if (from < s.size()) res.push_back(s.substr(from));
-			return res;
-		}
 
-		namespace impl
-		{
-			struct char_or_sv
+#ifdef __SIZEOF_INT128__
+			char* write_unsigned(char* out, unsigned __int128 value)
 			{
-				std::string_view sv;
-				operator std::string_view() const { return sv; }
-				operator char() const { return sv.front(); }
-			};
-		}
+				if (value <= ~0ull) return write_unsigned(out, static_cast<unsigned long long>(value));
 
-		template<typename TPred>
-		std::vector<std::string_view> split_if(
-			std::string_view s,
-			TPred pred,
-			bool includeEmpty = false
-		)
-		{
-			std::vector<std::string_view> res;
-			size_t from = 0;
-			for (size_t i = 0; i < s.size(); ++i)
+				// at most three chunks of 19 digits, the lower ones zero padded
+				const unsigned long long chunk = 10000000000000000000ull;
+				unsigned long long low = static_cast<unsigned long long>(value % chunk);
+				value /= chunk;
+				if (value <= ~0ull)
+				{
+					out = write_unsigned(out, static_cast<unsigned long long>(value));
+				}
+				else
+				{
+					unsigned long long middle = static_cast<unsigned long long>(value % chunk);
+					out = write_unsigned(out, static_cast<unsigned long long>(value / chunk));
+					write_digits(out + 19, middle, 19);
+					out += 19;
+				}
+				write_digits(out + 19, low, 19);
+				return out + 19;
+			}
+#endif
+
+			// writes decimal representation of an integer to out, which must have max_number_length free chars.
+			template<typename T>
+			char* write_integer(char* out, T value)
 			{
-				if (pred(impl::char_or_sv{ s.substr(i) }))
+#ifdef __SIZEOF_INT128__
+				using unsigned_type = std::conditional_t<is_int128_v<T>, unsigned __int128, unsigned long long>;
+#else
+				using unsigned_type = unsigned long long;
+#endif
+				unsigned_type absolute = static_cast<unsigned_type>(value);
+				if constexpr (is_signed_number_v<T>)
 				{
-					if (from < i || includeEmpty)
+					if (value < T(0))
 					{
-						res.push_back(s.substr(from, i - from));
+						*out++ = '-';
+						absolute = unsigned_type(0) - absolute;
 					}
-					from = i + 1;
 				}
+				return write_unsigned(out, absolute);
 			}
-			if (from < s.size()) res.push_back(s.substr(from));
-			return res;
-		}
 
-		std::string_view trim(std::string_view str)
-		{
-			while (!str.empty() && isspace(str.front())) str.remove_prefix(1);
-			while (!str.empty() && isspace(str.back())) str.remove_suffix(1);
-			return str;
-		}
+			// the way floating values are printed, mirrors std::ostream floatfield and precision.
+			struct number_format
+			{
+				std::chars_format float_format = std::chars_format::general;
+				int precision = 6;
+			};
 
-		bool starts_with(std::string_view str, std::string_view prefix)
-		{
-			return str.size() >= prefix.size() && str.substr(0, prefix.size()) == prefix;
+			// reads number format from the stream state.
+			// returns false if the stream is configured in a way only its own operator<< reproduces.
+			bool try_get_number_format(const std::ostream& out, number_format& format)
+			{
+				const auto supported = std::ios_base::dec | std::ios_base::skipws | std::ios_base::fixed | std::ios_base::scientific;
+				const auto flags = out.flags();
+				if ((flags & ~supported) || !(flags & std::ios_base::dec) || out.width() != 0) return false;
+				if (out.getloc() != std::locale::classic()) return false;
+
+				const auto floatfield = flags & std::ios_base::floatfield;
+				if (floatfield == std::ios_base::fixed) format.float_format = std::chars_format::fixed;
+				else if (floatfield == std::ios_base::scientific) format.float_format = std::chars_format::scientific;
+				else if (floatfield == 0) format.float_format = std::chars_format::general;
+				else return false;
+
+				format.precision = int(out.precision());
+				return format.precision >= 0;
+			}
+
+			// writes value to [first, last). returns nullptr if there is not enough space.
+			template<typename T>
+			char* write_number(char* first, char* last, T value, const number_format& format)
+			{
+				if constexpr (std::is_floating_point_v<T>)
+				{
+					auto res = std::to_chars(first, last, value, format.float_format, format.precision);
+					return res.ec == std::errc() ? res.ptr : nullptr;
+				}
+				else
+				{
+					if (size_t(last - first) < max_number_length) return nullptr;
+					return write_integer(first, value);
+				}
+			}
 		}
 
-		bool ends_with(std::string_view str, std::string_view suffix)
+		template<typename T>
+		const std::string to_string(const T& value)
 		{
-			return str.size() >= suffix.size() && str.substr(str.size() - suffix.size()) == suffix;
+			if constexpr (impl::is_fast_number_v<T>)
+			{
+				// fits into the buffer for default (general) format
+				char buffer[impl::max_number_length];
+				char* last = impl::write_number(buffer, buffer + sizeof(buffer), value, impl::number_format{});
+				return std::string(buffer, last);
+			}
+			else
+			{
+				std::ostringstream oss;
+				oss << value;
+				return oss.str();
+			}
 		}
 
-		bool enclosed_with(std::string_view str, std::string_view prefix, std::string_view suffix)
+		namespace impl
 		{
-			return str.size() >= prefix.size() + suffix.size() && starts_with(str, prefix) && ends_with(str, suffix);
-		}
+#if defined(PROBLIB_SIMD_SSE2) || defined(PROBLIB_SIMD_AVX2)
+			int count_trailing_zeros(unsigned value)
+			{
+#ifdef _MSC_VER
+				unsigned long index;
+				_BitScanForward(&index, value);
+				return int(index);
+#else
+				return __builtin_ctz(value);
+#endif
+			}
+#endif
 
+#ifdef PROBLIB_SIMD_SSE2
+			// returns first position in [from, size) whose char is (or is not, if !member)
+			// in one of the ranges [lo[i], lo[i] + width[i]], or size.
+			size_t find_in_ranges_sse2(const char* data, size_t from, size_t size,
+				const unsigned char* lo, const unsigned char* width, int count, bool member)
+			{
+				const unsigned flip = member ? 0u : 0xFFFFu;
+				size_t i = from;
+				for (; i + 16 <= size; i += 16)
+				{
+					__m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i));
+					__m128i hit = _mm_setzero_si128();
+					for (int r = 0; r < count; ++r)
+					{
+						__m128i shifted = _mm_sub_epi8(v, _mm_set1_epi8(char(lo[r])));
+						__m128i inside = _mm_cmpeq_epi8(_mm_min_epu8(shifted, _mm_set1_epi8(char(width[r]))), shifted);
+						hit = _mm_or_si128(hit, inside);
+					}
+					unsigned mask = unsigned(_mm_movemask_epi8(hit)) ^ flip;
+					if (mask) return i + count_trailing_zeros(mask);
+				}
+				return i;
+			}
+#endif
 
-		bool try_remove_prefix(std::string_view & str, std::string_view prefix)
-		{
-			if (starts_with(str, prefix))
+#ifdef PROBLIB_SIMD_AVX2
+			__attribute__((target("avx2")))
+			size_t find_in_ranges_avx2(const char* data, size_t from, size_t size,
+				const unsigned char* lo, const unsigned char* width, int count, bool member)
 			{
-				str.remove_prefix(prefix.size());
-				return true;
+				const unsigned flip = member ? 0u : 0xFFFFFFFFu;
+				size_t i = from;
+				for (; i + 32 <= size; i += 32)
+				{
+					__m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i));
+					__m256i hit = _mm256_setzero_si256();
+					for (int r = 0; r < count; ++r)
+					{
+						__m256i shifted = _mm256_sub_epi8(v, _mm256_set1_epi8(char(lo[r])));
+						__m256i inside = _mm256_cmpeq_epi8(_mm256_min_epu8(shifted, _mm256_set1_epi8(char(width[r]))), shifted);
+						hit = _mm256_or_si256(hit, inside);
+					}
+					unsigned mask = unsigned(_mm256_movemask_epi8(hit)) ^ flip;
+					if (mask) return i + count_trailing_zeros(mask);
+				}
+				return i;
 			}
-			return false;
-		}
 
-		bool try_remove_suffix(std::string_view & str, std::string_view suffix)
-		{
-			if (ends_with(str, suffix))
+			bool cpu_has_avx2()
 			{
-				str.remove_suffix(suffix.size());
-				return true;
+				static const bool value = __builtin_cpu_supports("avx2");
+				return value;
 			}
-			return false;
+#endif
 		}
 
-		bool try_remove_enclosed(std::string_view & str, std::string_view prefix, std::string_view suffix)
+		// set of chars with a 256-entry membership table built at compile time.
+		// classes made of a few contiguous ranges (e.g. whitespace, digits, letters) are scanned with SSE2/AVX2
+		// when available, others fall back to table lookups.
+		class char_class
 		{
-			if (enclosed_with(str, prefix, suffix))
+		public:
+			static constexpr int max_simd_ranges = 4;
+
+			constexpr char_class() : _table{}, _lo{}, _width{}, _range_count(0) {}
+
+			constexpr explicit char_class(std::string_view chars) : char_class()
 			{
-				str.remove_prefix(prefix.size());
-				str.remove_suffix(suffix.size());
-				return true;
+				for (char c : chars) _table[static_cast<unsigned char>(c)] = true;
+				_update_ranges();
 			}
-			return false;
-		}
-	}
 
+			// class of chars in [from, to]
+			static constexpr char_class range(char from, char to)
+			{
+				char_class result;
+				for (unsigned c = static_cast<unsigned char>(from); c <= static_cast<unsigned char>(to); ++c) result._table[c] = true;
+				result._update_ranges();
+				return result;
+			}
 
-	// if value < lowerBound, returns lowerBound.
-	// if value > upperBound returns upperBound.
-	// else returns value.
-	template<typename T>
-	T bound_value(const T & lowerBound, const T & upperBound, const T & value)
-	{
-		return std::min<T>(upperBound, std::max<T>(lowerBound, value));
-	}
+			// chars for which isspace is true in the "C" locale
+			static constexpr char_class space() { return char_class(" \t\n\v\f\r"); }
 
-	template<typename T, typename U>
-	std::enable_if_t < std::is_integral<T>::value, T > pow(T x, U y)
-	{
-		if (!y) return 1;
-		T p = Pow(x, y >> 1);
-		p *= p;
-		if (y & 1) p *= x;
-		return p;
-	}
+			constexpr bool contains(char c) const { return _table[static_cast<unsigned char>(c)]; }
+			constexpr bool operator()(char c) const { return contains(c); }
 
-	template<typename T, typename U>
-	std::enable_if_t < std::is_integral<T>::value, T > pow_mod(T x, U y, T m)
-	{
-		if (!y) return 1;
-		T p = Pow(x, y >> 1);
-		p = p * p % m;
-		if (y & 1) p = p * x % m;
-		return p;
-	}
+			constexpr char_class operator|(const char_class& other) const
+			{
+				char_class result;
+				for (int c = 0; c < 256; ++c) result._table[c] = _table[c] || other._table[c];
+				result._update_ranges();
+				return result;
+			}
 
-	namespace impl
-	{
-		template<typename TIt>
-		struct collection_printer
-		{
-			TIt first;
-			TIt last;
-			std::string_view separator;
-		};
+			constexpr char_class operator~() const
+			{
+				char_class result;
+				for (int c = 0; c < 256; ++c) result._table[c] = !_table[c];
+				result._update_ranges();
+				return result;
+			}
 
+			// returns position of the first char of s in the class starting from pos, or npos.
+			size_t find_first(std::string_view s, size_t pos = 0) const { return _find<true>(s, pos); }
 
-		template<typename TIt>
-		std::ostream& operator <<(std::ostream& out, const collection_printer<TIt>& printer)
-		{
-			auto cur = printer.first;
-			if (cur == printer.last) return out;
-			out << *cur;
-			for (++cur; cur != printer.last; ++cur) out << printer.separator << *cur;
-			return out;
-		}
+			// returns position of the first char of s not in the class starting from pos, or npos.
+			size_t find_first_not(std::string_view s, size_t pos = 0) const { return _find<false>(s, pos); }
 
-	}
+			// returns position of the last char of s not in the class, or npos.
+			size_t find_last_not(std::string_view s) const
+			{
+				for (size_t i = s.size(); i > 0; --i)
+				{
+					if (!contains(s[i - 1])) return i - 1;
+				}
+				return std::string_view::npos;
+			}
 
-	template<typename TIt>
-	auto make_printer(TIt first, TIt last, std::string_view separator = " ")
-	{
-		return impl::collection_printer<TIt> { first, last, separator };
-	}
+			// removes chars in the class from both ends of s.
+			std::string_view trim(std::string_view s) const
+			{
+				size_t first = find_first_not(s);
+				if (first == std::string_view::npos) return s.substr(s.size());
+				return s.substr(first, find_last_not(s) - first + 1);
+			}
 
-	template<typename TContainer>
-	auto make_printer(const TContainer & c, std::string_view separator = " ")
-	{
-		using std::begin;
-		using std::end;
+		private:
+			bool _table[256];
+			// contiguous ranges [_lo[i], _lo[i] + _width[i]] of the class,
+			// _range_count is -1 if there are more than max_simd_ranges of them.
+			unsigned char _lo[max_simd_ranges];
+			unsigned char _width[max_simd_ranges];
+			int _range_count;
+
+			constexpr void _update_ranges()
+			{
+				_range_count = 0;
+				for (int c = 0; c < 256; ++c)
+				{
+					if (!_table[c] || (c > 0 && _table[c - 1])) continue;
+					if (_range_count == max_simd_ranges)
+					{
+						_range_count = -1;
+						return;
+					}
+					int to = c;
+					while (to + 1 < 256 && _table[to + 1]) ++to;
+					_lo[_range_count] = static_cast<unsigned char>(c);
+					_width[_range_count] = static_cast<unsigned char>(to - c);
+					++_range_count;
+				}
+			}
+
+			template<bool Member>
+			size_t _find(std::string_view s, size_t pos) const
+			{
+				size_t i = pos;
+				if (i >= s.size()) return std::string_view::npos;
+#ifdef PROBLIB_SIMD_AVX2
+				if (_range_count >= 0 && impl::cpu_has_avx2())
+				{
+					i = impl::find_in_ranges_avx2(s.data(), i, s.size(), _lo, _width, _range_count, Member);
+				}
+#endif
+#ifdef PROBLIB_SIMD_SSE2
+				if (_range_count >= 0)
+				{
+					i = impl::find_in_ranges_sse2(s.data(), i, s.size(), _lo, _width, _range_count, Member);
+				}
+#endif
+				for (; i < s.size(); ++i)
+				{
+					if (contains(s[i]) == Member) return i;
+				}
+				return std::string_view::npos;
+			}
+		};
+
+		namespace impl
+		{
+			struct char_or_sv
+			{
+				std::string_view sv;
+				operator std::string_view() const { return sv; }
+				operator char() const { return sv.front(); }
+			};
+
+			// substring search: memchr for single characters,
+			// Crochemore-Perrin two-way algorithm (linear time, constant memory) for longer needles.
+			class substring_searcher
+			{
+			public:
+				explicit substring_searcher(std::string_view needle)
+					: _needle(needle), _critical(0), _period(1), _memory(0)
+				{
+					assert(!needle.empty());
+					if (needle.size() > 1) _factorize();
+				}
+
+				size_t length() const { return _needle.size(); }
+
+				// returns position of the first occurrence of needle in s starting from pos, or npos.
+				size_t find(std::string_view s, size_t pos) const
+				{
+					const size_t n = _needle.size();
+					if (pos > s.size() || s.size() - pos < n) return std::string_view::npos;
+
+					if (n == 1)
+					{
+						auto found = static_cast<const char*>(std::memchr(s.data() + pos, _needle.front(), s.size() - pos));
+						return found ? size_t(found - s.data()) : std::string_view::npos;
+					}
+
+					const auto x = reinterpret_cast<const unsigned char*>(_needle.data());
+					const auto y = reinterpret_cast<const unsigned char*>(s.data());
+					const size_t last = s.size() - n;
+					size_t memory = 0;
+					size_t j = pos;
+					while (j <= last)
+					{
+						size_t i = std::max(_critical, memory);
+						while (i < n && x[i] == y[i + j]) ++i;
+						if (i < n)
+						{
+							j += i - _critical + 1;
+							memory = 0;
+							continue;
+						}
+
+						i = _critical;
+						while (i > memory && x[i - 1] == y[i - 1 + j]) --i;
+						if (i <= memory) return j;
+
+						j += _period;
+						memory = _memory;
+					}
+					return std::string_view::npos;
+				}
+
+			private:
+				std::string_view _needle;
+				// start of the right half of the critical factorization
+				size_t _critical;
+				size_t _period;
+				// length of the prefix known to match after a period shift (periodic needles only)
+				size_t _memory;
+
+				// returns start of the maximal suffix and its period
+				std::pair<size_t, size_t> _maximal_suffix(bool reversed) const
+				{
+					const auto x = reinterpret_cast<const unsigned char*>(_needle.data());
+					const size_t n = _needle.size();
+					size_t suffix = 0, j = 1, k = 0, period = 1;
+					while (j + k < n)
+					{
+						unsigned char a = x[j + k];
+						unsigned char b = x[suffix + k];
+						if (a == b)
+						{
+							if (k + 1 == period)
+							{
+								j += period;
+								k = 0;
+							}
+							else ++k;
+						}
+						else if (reversed ? a > b : a < b)
+						{
+							j += k + 1;
+							k = 0;
+							period = j - suffix;
+						}
+						else
+						{
+							suffix = j++;
+							k = 0;
+							period = 1;
+						}
+					}
+					return { suffix, period };
+				}
+
+				void _factorize()
+				{
+					auto direct = _maximal_suffix(false);
+					auto reversed = _maximal_suffix(true);
+					auto factorization = direct.first > reversed.first ? direct : reversed;
+					_critical = factorization.first;
+					_period = factorization.second;
+
+					const size_t n = _needle.size();
+					if (_period <= n - _critical && _needle.compare(0, _critical, _needle, _period, _critical) == 0)
+					{
+						_memory = n - _period;
+					}
+					else
+					{
+						_period = std::max(_critical, n - _critical) + 1;
+						_memory = 0;
+					}
+				}
+			};
+
+			template<typename TPred>
+			struct predicate_searcher
+			{
+				TPred pred;
+
+				size_t length() const { return 1; }
+
+				size_t find(std::string_view s, size_t pos) const
+				{
+					for (size_t i = pos; i < s.size(); ++i)
+					{
+						if (pred(char_or_sv{ s.substr(i) })) return i;
+					}
+					return std::string_view::npos;
+				}
+			};
+
+			// char classes are searched block-wise instead of one predicate call per char
+			template<>
+			struct predicate_searcher<char_class>
+			{
+				char_class pred;
+
+				size_t length() const { return 1; }
+
+				size_t find(std::string_view s, size_t pos) const { return pred.find_first(s, pos); }
+			};
+
+			// lazy range of the pieces of a string between delimiters found by TSearcher.
+			// empty pieces before delimiters are yielded only if include_empty is set, trailing empty piece is never yielded.
+			template<typename TSearcher>
+			class split_range
+			{
+			public:
+				class iterator
+				{
+				public:
+					using iterator_category = std::forward_iterator_tag;
+					using value_type = std::string_view;
+					using difference_type = std::ptrdiff_t;
+					using pointer = const std::string_view*;
+					using reference = const std::string_view&;
+
+					iterator() : _range(nullptr), _next(0) {}
+
+					reference operator*() const { return _current; }
+					pointer operator->() const { return &_current; }
+
+					iterator& operator++()
+					{
+						_advance();
+						return *this;
+					}
+
+					iterator operator++(int)
+					{
+						auto result = *this;
+						_advance();
+						return result;
+					}
+
+					bool operator==(const iterator& other) const
+					{
+						return _range == other._range && (!_range || _current.data() == other._current.data());
+					}
+
+					bool operator!=(const iterator& other) const { return !(*this == other); }
+
+				private:
+					friend class split_range;
+
+					const split_range* _range;
+					std::string_view _current;
+					size_t _next;
+
+					explicit iterator(const split_range* range) : _range(range), _next(0) { _advance(); }
+
+					void _advance()
+					{
+						const auto s = _range->_s;
+						while (_next < s.size())
+						{
+							size_t found = _range->_searcher.find(s, _next);
+							if (found == std::string_view::npos)
+							{
+								_current = s.substr(_next);
+								_next = s.size();
+								return;
+							}
+
+							auto piece = s.substr(_next, found - _next);
+							_next = found + _range->_searcher.length();
+							if (!piece.empty() || _range->_include_empty)
+							{
+								_current = piece;
+								return;
+							}
+						}
+						_range = nullptr;
+						_current = std::string_view();
+					}
+				};
+
+				split_range(std::string_view s, TSearcher searcher, bool include_empty)
+					: _s(s), _searcher(std::move(searcher)), _include_empty(include_empty)
+				{}
+
+				iterator begin() const { return iterator(this); }
+				iterator end() const { return iterator(); }
+
+			private:
+				std::string_view _s;
+				TSearcher _searcher;
+				bool _include_empty;
+			};
+		}
+
+		// lazy version of split: pieces are searched on iteration, nothing is allocated.
+		// s must outlive the returned range.
+		impl::split_range<impl::substring_searcher> split_view(
+			std::string_view s,
+			std::string_view splitter,
+			bool includeEmpty = false
+		)
+		{
+			return impl::split_range<impl::substring_searcher>(s, impl::substring_searcher(splitter), includeEmpty);
+		}
+
+		// lazy version of split_if: pieces are searched on iteration, nothing is allocated.
+		// s must outlive the returned range.
+		template<typename TPred>
+		impl::split_range<impl::predicate_searcher<TPred>> split_if_view(
+			std::string_view s,
+			TPred pred,
+			bool includeEmpty = false
+		)
+		{
+			return impl::split_range<impl::predicate_searcher<TPred>>(s, impl::predicate_searcher<TPred>{ pred }, includeEmpty);
+		}
+
+		std::vector<std::string_view> split(
+			std::string_view s,
+			std::string_view splitter,
+			bool includeEmpty = false
+		)
+		{
+			std::vector<std::string_view> res;
+			for (auto part : split_view(s, splitter, includeEmpty)) res.push_back(part);
+			return res;
+		}
+
+		template<typename TPred>
+		std::vector<std::string_view> split_if(
+			std::string_view s,
+			TPred pred,
+			bool includeEmpty = false
+		)
+		{
+			std::vector<std::string_view> res;
+			for (auto part : split_if_view(s, pred, includeEmpty)) res.push_back(part);
+			return res;
+		}
+
+		std::string_view trim(std::string_view str)
+		{
+			static constexpr char_class spaces = char_class::space();
+			return spaces.trim(str);
+		}
+
+		constexpr bool starts_with(std::string_view str, std::string_view prefix)
+		{
+			return str.size() >= prefix.size() && str.substr(0, prefix.size()) == prefix;
+		}
+
+		constexpr bool ends_with(std::string_view str, std::string_view suffix)
+		{
+			return str.size() >= suffix.size() && str.substr(str.size() - suffix.size()) == suffix;
+		}
+
+		constexpr bool enclosed_with(std::string_view str, std::string_view prefix, std::string_view suffix)
+		{
+			return str.size() >= prefix.size() + suffix.size() && starts_with(str, prefix) && ends_with(str, suffix);
+		}
+
+
+		constexpr bool try_remove_prefix(std::string_view & str, std::string_view prefix)
+		{
+			if (starts_with(str, prefix))
+			{
+				str.remove_prefix(prefix.size());
+				return true;
+			}
+			return false;
+		}
+
+		constexpr bool try_remove_suffix(std::string_view & str, std::string_view suffix)
+		{
+			if (ends_with(str, suffix))
+			{
+				str.remove_suffix(suffix.size());
+				return true;
+			}
+			return false;
+		}
+
+		constexpr bool try_remove_enclosed(std::string_view & str, std::string_view prefix, std::string_view suffix)
+		{
+			if (enclosed_with(str, prefix, suffix))
+			{
+				str.remove_prefix(prefix.size());
+				str.remove_suffix(suffix.size());
+				return true;
+			}
+			return false;
+		}
+	}
+
+
+	// if value < lowerBound, returns lowerBound.
+	// if value > upperBound returns upperBound.
+	// else returns value.
+	template<typename T>
+	T bound_value(const T & lowerBound, const T & upperBound, const T & value)
+	{
+		return std::min<T>(upperBound, std::max<T>(lowerBound, value));
+	}
+
+	template<typename T, typename U>
+	std::enable_if_t < std::is_integral<T>::value, T > pow(T x, U y)
+	{
+		// a negative exponent would never be shifted to zero
+		if constexpr (std::is_signed_v<U>) assert(y >= 0);
+		T result = 1;
+		for (; y; y >>= 1)
+		{
+			if (y & 1) result *= x;
+			if (y > 1) x *= x;
+		}
+		return result;
+	}
+
+#pragma region modular arithmetic
+
+	// returns high 64 bits of a * b.
+	constexpr unsigned long long mul_high(unsigned long long a, unsigned long long b)
+	{
+#ifdef __SIZEOF_INT128__
+		return static_cast<unsigned long long>((static_cast<unsigned __int128>(a) * b) >> 64);
+#else
+		unsigned long long aLow = a & 0xFFFFFFFFull, aHigh = a >> 32;
+		unsigned long long bLow = b & 0xFFFFFFFFull, bHigh = b >> 32;
+		unsigned long long low = aLow * bLow;
+		unsigned long long middle1 = aHigh * bLow + (low >> 32);
+		unsigned long long middle2 = aLow * bHigh + (middle1 & 0xFFFFFFFFull);
+		return aHigh * bHigh + (middle1 >> 32) + (middle2 >> 32);
+#endif
+	}
+
+	// returns a * b % m without overflow for any 64-bit values.
+#if defined(__SIZEOF_INT128__)
+	constexpr unsigned long long mul_mod(unsigned long long a, unsigned long long b, unsigned long long m)
+	{
+		return static_cast<unsigned long long>(static_cast<unsigned __int128>(a) * b % m);
+	}
+#else
+	constexpr unsigned long long mul_mod(unsigned long long a, unsigned long long b, unsigned long long m)
+	{
+		a %= m;
+		b %= m;
+		if ((a | b) >> 32 == 0) return a * b % m;
+		unsigned long long result = 0;
+		for (; b; b >>= 1)
+		{
+			if (b & 1) result = result >= m - a ? result - (m - a) : result + a;
+			a = a >= m - a ? a - (m - a) : a + a;
+		}
+		return result;
+	}
+#endif
+
+	// the same as mul_mod, evaluated only at runtime: MSVC x64 has no __int128
+	// but its 128-bit multiplication and division intrinsics are not constexpr.
+	unsigned long long mul_mod_runtime(unsigned long long a, unsigned long long b, unsigned long long m)
+	{
+#if !defined(__SIZEOF_INT128__) && defined(_MSC_VER) && defined(_M_X64)
+		a %= m;
+		b %= m;
+		unsigned long long high;
+		unsigned long long low = _umul128(a, b, &high);
+		unsigned long long remainder;
+		_udiv128(high, low, m, &remainder);
+		return remainder;
+#else
+		return mul_mod(a, b, m);
+#endif
+	}
+
+	// returns inverse of a modulo m, a and m must be coprime.
+	constexpr unsigned long long inv_mod(unsigned long long a, unsigned long long m)
+	{
+		// extended Euclid keeping coefficients of a modulo m
+		unsigned long long r0 = m, r1 = a % m;
+		unsigned long long t0 = 0, t1 = 1;
+		while (r1)
+		{
+			unsigned long long q = r0 / r1;
+			unsigned long long r2 = r0 - q * r1;
+			// t0 - q * t1 modulo m, t0 + m may overflow for moduli above 2^63
+			unsigned long long s = mul_mod(q % m, t1, m);
+			unsigned long long t2 = t0 >= s ? t0 - s : t0 + (m - s);
+			r0 = r1, r1 = r2;
+			t0 = t1, t1 = t2;
+		}
+		assert(r0 == 1 && "value is not invertible");
+		return m == 1 ? 0 : t0;
+	}
+
+	// Barrett reduction for a modulus known at runtime.
+	// moduli below 2^32 take the reduction path, larger ones use 128-bit division.
+	class barrett_reduction
+	{
+	public:
+		explicit barrett_reduction(unsigned long long m)
+			: _m(m), _im(m >= 2 && m <= 0xFFFFFFFFull ? ~0ull / m + 1 : 0)
+		{
+			assert(m >= 1);
+		}
+
+		unsigned long long mod() const { return _m; }
+
+		// a and b must be less than mod()
+		unsigned long long mul(unsigned long long a, unsigned long long b) const
+		{
+			if (!_im) return mul_mod_runtime(a, b, _m);
+			unsigned long long z = a * b;
+			unsigned long long x = mul_high(z, _im);
+			unsigned long long y = x * _m;
+			return z - y + (z < y ? _m : 0);
+		}
+
+		// returns z % mod() for any 64-bit z
+		unsigned long long reduce(unsigned long long z) const
+		{
+			if (!_im) return z % _m;
+			// the quotient estimate is exact or one too big, then the difference wraps below zero
+			unsigned long long value = z - mul_high(z, _im) * _m;
+			return value >= _m ? value + _m : value;
+		}
+
+		unsigned long long pow(unsigned long long a, unsigned long long e) const
+		{
+			unsigned long long result = 1 % _m;
+			for (; e; e >>= 1)
+			{
+				if (e & 1) result = mul(result, a);
+				if (e > 1) a = mul(a, a);
+			}
+			return result;
+		}
+
+	private:
+		unsigned long long _m;
+		// ceil(2^64 / m), 0 if the reduction is not applicable
+		unsigned long long _im;
+	};
+
+	template<typename T, typename U>
+	std::enable_if_t < std::is_integral<T>::value, T > pow_mod(T x, U y, T m)
+	{
+		assert(m > 0 && y >= 0);
+		auto um = static_cast<unsigned long long>(m);
+		auto ux = x < 0
+			? (um - static_cast<unsigned long long>(-(x % m))) % um
+			: static_cast<unsigned long long>(x) % um;
+		return static_cast<T>(barrett_reduction(um).pow(ux, static_cast<unsigned long long>(y)));
+	}
+
+	namespace impl
+	{
+		template<typename T>
+		constexpr unsigned long long normalize_mod(T value, unsigned long long m)
+		{
+#ifdef __SIZEOF_INT128__
+			using unsigned_type = std::conditional_t<str::impl::is_int128_v<T>, unsigned __int128, unsigned long long>;
+#else
+			using unsigned_type = unsigned long long;
+#endif
+			bool negative = false;
+			if constexpr (str::impl::is_signed_number_v<T>) negative = value < 0;
+			unsigned_type absolute = negative ? unsigned_type(0) - unsigned_type(value) : unsigned_type(value);
+			unsigned long long r = static_cast<unsigned long long>(absolute % m);
+			return negative && r ? m - r : r;
+		}
+
+		template<typename TDerived>
+		struct modint_operators
+		{
+			friend constexpr TDerived operator+(TDerived a, const TDerived& b) { return a += b; }
+			friend constexpr TDerived operator-(TDerived a, const TDerived& b) { return a -= b; }
+			friend constexpr TDerived operator*(TDerived a, const TDerived& b) { return a *= b; }
+			friend constexpr TDerived operator/(TDerived a, const TDerived& b) { return a /= b; }
+			friend constexpr bool operator==(const TDerived& a, const TDerived& b) { return a.val() == b.val(); }
+			friend constexpr bool operator!=(const TDerived& a, const TDerived& b) { return a.val() != b.val(); }
+
+			friend std::ostream& operator<<(std::ostream& out, const TDerived& value) { return out << value.val(); }
+		};
+	}
+
+	// value modulo compile-time modulus M.
+	template<unsigned long long M>
+	class modint : public impl::modint_operators<modint<M>>
+	{
+		static_assert(M >= 1, "modulus must be positive");
+
+	public:
+		static constexpr unsigned long long mod() { return M; }
+
+		constexpr modint() : _v(0) {}
+
+		template<typename T, typename = std::enable_if_t<std::is_integral_v<T> || str::impl::is_int128_v<T>>>
+		constexpr modint(T value) : _v(impl::normalize_mod(value, M)) {}
+
+		constexpr unsigned long long val() const { return _v; }
+
+		constexpr modint& operator+=(const modint& other)
+		{
+			_v = _v >= M - other._v ? _v - (M - other._v) : _v + other._v;
+			return *this;
+		}
+
+		constexpr modint& operator-=(const modint& other)
+		{
+			_v = _v >= other._v ? _v - other._v : _v + (M - other._v);
+			return *this;
+		}
+
+		constexpr modint& operator*=(const modint& other)
+		{
+			if constexpr (M <= 0x100000000ull) _v = _v * other._v % M;
+			else _v = mul_mod(_v, other._v, M);
+			return *this;
+		}
+
+		constexpr modint& operator/=(const modint& other) { return *this *= other.inv(); }
+
+		constexpr modint operator-() const { return modint() - *this; }
+
+		constexpr modint pow(unsigned long long e) const
+		{
+			modint result = 1, a = *this;
+			for (; e; e >>= 1)
+			{
+				if (e & 1) result *= a;
+				if (e > 1) a *= a;
+			}
+			return result;
+		}
+
+		constexpr modint inv() const { return from_raw(inv_mod(_v, M)); }
+
+		// value must already be less than M
+		static constexpr modint from_raw(unsigned long long value)
+		{
+			modint result;
+			result._v = value;
+			return result;
+		}
+
+	private:
+		unsigned long long _v;
+	};
+
+	using modint1000000007 = modint<1000000007>;
+	using modint998244353 = modint<998244353>;
+
+	// value modulo runtime modulus, shared by all instances with the same Id.
+	// set_mod must be called before values are created.
+	template<int Id = -1>
+	class dynamic_modint : public impl::modint_operators<dynamic_modint<Id>>
+	{
+	public:
+		static void set_mod(unsigned long long m) { _reduction = barrett_reduction(m); }
+		static unsigned long long mod() { return _reduction.mod(); }
+
+		dynamic_modint() : _v(0) {}
+
+		template<typename T, typename = std::enable_if_t<std::is_integral_v<T> || str::impl::is_int128_v<T>>>
+		dynamic_modint(T value) : _v(impl::normalize_mod(value, mod())) {}
+
+		unsigned long long val() const { return _v; }
+
+		dynamic_modint& operator+=(const dynamic_modint& other)
+		{
+			const unsigned long long m = mod();
+			_v = _v >= m - other._v ? _v - (m - other._v) : _v + other._v;
+			return *this;
+		}
+
+		dynamic_modint& operator-=(const dynamic_modint& other)
+		{
+			_v = _v >= other._v ? _v - other._v : _v + (mod() - other._v);
+			return *this;
+		}
+
+		dynamic_modint& operator*=(const dynamic_modint& other)
+		{
+			_v = _reduction.mul(_v, other._v);
+			return *this;
+		}
+
+		dynamic_modint& operator/=(const dynamic_modint& other) { return *this *= other.inv(); }
+
+		dynamic_modint operator-() const { return dynamic_modint() - *this; }
+
+		dynamic_modint pow(unsigned long long e) const { return from_raw(_reduction.pow(_v, e)); }
+
+		dynamic_modint inv() const { return from_raw(inv_mod(_v, mod())); }
+
+		// value must already be less than mod()
+		static dynamic_modint from_raw(unsigned long long value)
+		{
+			dynamic_modint result;
+			result._v = value;
+			return result;
+		}
+
+	private:
+		static barrett_reduction _reduction;
+		unsigned long long _v;
+	};
+
+	template<int Id>
+	barrett_reduction dynamic_modint<Id>::_reduction(998244353);
+
+#pragma endregion
+
+	namespace impl
+	{
+		template<typename TIt>
+		struct collection_printer
+		{
+			TIt first;
+			TIt last;
+			std::string_view separator;
+		};
+
+
+		// formats numbers and separators into a fixed block and writes it to the stream when full.
+		class stream_number_buffer
+		{
+		public:
+			stream_number_buffer(std::ostream& out, const str::impl::number_format& format)
+				: _out(out), _format(format), _size(0)
+			{}
+
+			stream_number_buffer(const stream_number_buffer&) = delete;
+			stream_number_buffer& operator=(const stream_number_buffer&) = delete;
+
+			~stream_number_buffer() { flush(); }
+
+			void write(std::string_view s)
+			{
+				if (s.size() > sizeof(_data) - _size)
+				{
+					flush();
+					if (s.size() > sizeof(_data))
+					{
+						_out.write(s.data(), s.size());
+						return;
+					}
+				}
+				std::memcpy(_data + _size, s.data(), s.size());
+				_size += s.size();
+			}
+
+			template<typename T>
+			void write_number(T value)
+			{
+				char* last = str::impl::write_number(_data + _size, _data + sizeof(_data), value, _format);
+				if (!last)
+				{
+					flush();
+					last = str::impl::write_number(_data, _data + sizeof(_data), value, _format);
+					if constexpr (std::is_floating_point_v<T>)
+					{
+						// fixed format with huge precision
+						if (!last)
+						{
+							_out << value;
+							return;
+						}
+					}
+				}
+				_size = last - _data;
+			}
+
+			void flush()
+			{
+				if (_size) _out.write(_data, _size);
+				_size = 0;
+			}
+
+		private:
+			std::ostream& _out;
+			str::impl::number_format _format;
+			size_t _size;
+			char _data[1 << 16];
+		};
+
+		template<typename TIt>
+		std::ostream& operator <<(std::ostream& out, const collection_printer<TIt>& printer)
+		{
+			auto cur = printer.first;
+			if (cur == printer.last) return out;
+
+			using value_type = std::decay_t<decltype(*cur)>;
+			if constexpr (str::impl::is_fast_number_v<value_type>)
+			{
+				str::impl::number_format format;
+				if (str::impl::try_get_number_format(out, format))
+				{
+					stream_number_buffer buffer(out, format);
+					buffer.write_number(*cur);
+					for (++cur; cur != printer.last; ++cur)
+					{
+						buffer.write(printer.separator);
+						buffer.write_number(*cur);
+					}
+					return out;
+				}
+			}
+
+			out << *cur;
+			for (++cur; cur != printer.last; ++cur) out << printer.separator << *cur;
+			return out;
+		}
+
+	}
+
+	template<typename TIt>
+	auto make_printer(TIt first, TIt last, std::string_view separator = " ")
+	{
+		return impl::collection_printer<TIt> { first, last, separator };
+	}
+
+	template<typename TContainer>
+	auto make_printer(const TContainer & c, std::string_view separator = " ")
+	{
+		using std::begin;
+		using std::end;
 		return make_printer(begin(c), end(c), separator);
 	}
 
-#pragma region ranges
+	namespace io
+	{
+		// buffered output to a file descriptor (stdout by default) or to an in-memory string.
+		// data is written only when the buffer is full, on flush() and on destruction,
+		// so mixing it with stdio/iostream output to the same file requires flushing both.
+		class writer
+		{
+		public:
+			static constexpr size_t default_buffer_size = 1 << 16;
+
+			writer() : writer(_stdout_fd()) {}
+
+			explicit writer(int fd, size_t bufferSize = default_buffer_size)
+				: _fd(fd), _target(nullptr), _buffer(std::max<size_t>(bufferSize, str::impl::max_number_length)), _size(0)
+			{}
+
+			// appends all output to target.
+			explicit writer(std::string& target, size_t bufferSize = default_buffer_size)
+				: _fd(-1), _target(&target), _buffer(std::max<size_t>(bufferSize, str::impl::max_number_length)), _size(0)
+			{}
+
+			writer(const writer&) = delete;
+			writer& operator=(const writer&) = delete;
+
+			~writer()
+			{
+				try
+				{
+					flush();
+				}
+				catch (...)
+				{
+				}
+			}
+
+			// floating values are written like std::ostream with the same precision and floatfield.
+			writer& precision(int value)
+			{
+				_format.precision = value;
+				return *this;
+			}
+
+			writer& float_format(std::chars_format value)
+			{
+				_format.float_format = value;
+				return *this;
+			}
+
+			writer& write(std::string_view s)
+			{
+				if (s.size() > _buffer.size() - _size)
+				{
+					flush();
+					if (s.size() >= _buffer.size())
+					{
+						_write_out(s.data(), s.size());
+						return *this;
+					}
+				}
+				std::memcpy(_buffer.data() + _size, s.data(), s.size());
+				_size += s.size();
+				return *this;
+			}
+
+			writer& write(char c)
+			{
+				if (_size == _buffer.size()) flush();
+				_buffer[_size++] = c;
+				return *this;
+			}
+
+			template<typename T>
+			writer& write_number(T value)
+			{
+				char* first = _buffer.data() + _size;
+				char* last = _buffer.data() + _buffer.size();
+				char* end = str::impl::write_number(first, last, value, _format);
+				if (!end)
+				{
+					flush();
+					end = str::impl::write_number(_buffer.data(), last, value, _format);
+					if constexpr (std::is_floating_point_v<T>)
+					{
+						// fixed format with huge precision
+						if (!end)
+						{
+							std::ostringstream oss;
+							oss.precision(_format.precision);
+							if (_format.float_format == std::chars_format::fixed) oss << std::fixed;
+							if (_format.float_format == std::chars_format::scientific) oss << std::scientific;
+							oss << value;
+							return write(oss.str());
+						}
+					}
+				}
+				_size = end - _buffer.data();
+				return *this;
+			}
+
+			// writes items of the range separated by separator.
+			template<typename TIt>
+			writer& write_range(TIt first, TIt last, std::string_view separator = " ")
+			{
+				if (first == last) return *this;
+				*this << *first;
+				for (++first; first != last; ++first) write(separator) << *first;
+				return *this;
+			}
+
+			template<typename TContainer>
+			writer& write_range(const TContainer& c, std::string_view separator = " ")
+			{
+				using std::begin;
+				using std::end;
+				return write_range(begin(c), end(c), separator);
+			}
+
+			template<typename T>
+			writer& operator<<(const T& value)
+			{
+				if constexpr (std::is_same_v<T, char>)
+				{
+					return write(value);
+				}
+				else if constexpr (str::impl::is_fast_number_v<T> || std::is_same_v<T, bool>)
+				{
+					return write_number(value);
+				}
+				else if constexpr (std::is_convertible_v<const T&, std::string_view>)
+				{
+					return write(std::string_view(value));
+				}
+				else
+				{
+					std::ostringstream oss;
+					oss << value;
+					return write(oss.str());
+				}
+			}
+
+			template<typename TIt>
+			writer& operator<<(const impl::collection_printer<TIt>& printer)
+			{
+				return write_range(printer.first, printer.last, printer.separator);
+			}
+
+			void flush()
+			{
+				if (!_size) return;
+				size_t size = _size;
+				_size = 0;
+				_write_out(_buffer.data(), size);
+			}
+
+		private:
+			int _fd;
+			std::string* _target;
+			std::vector<char> _buffer;
+			size_t _size;
+			str::impl::number_format _format;
+
+			static int _stdout_fd()
+			{
+#ifdef _WIN32
+				return _fileno(stdout);
+#else
+				return fileno(stdout);
+#endif
+			}
+
+			void _write_out(const char* data, size_t size)
+			{
+				if (_target)
+				{
+					_target->append(data, size);
+					return;
+				}
+
+				while (size > 0)
+				{
+#ifdef _WIN32
+					const unsigned chunk = unsigned(std::min<size_t>(size, 1u << 30));
+					int written = _write(_fd, data, chunk);
+#else
+					ssize_t written = ::write(_fd, data, size);
+					if (written < 0 && errno == EINTR) continue;
+#endif
+					if (written <= 0) throw std::runtime_error("Writing to file descriptor failed.");
+					data += written;
+					size -= size_t(written);
+				}
+			}
+		};
+	}
+
+#ifdef _TESTLIB_H_
+#pragma region batch random
+
+	namespace impl
+	{
+		// affine map x -> (a * x + c) mod 2^48, a power of the step of testlib random_t generator
+		struct lcg_affine
+		{
+			static constexpr unsigned long long mask = (1ull << 48) - 1;
+
+			unsigned long long a = 1;
+			unsigned long long c = 0;
+
+			constexpr unsigned long long apply(unsigned long long x) const { return (a * x + c) & mask; }
+
+			// returns map applying this one and then the other one
+			constexpr lcg_affine then(const lcg_affine& other) const
+			{
+				return lcg_affine{ (other.a * a) & mask, (other.a * c + other.c) & mask };
+			}
+
+			constexpr lcg_affine pow(unsigned long long k) const
+			{
+				lcg_affine result, current = *this;
+				for (; k; k >>= 1)
+				{
+					if (k & 1) result = result.then(current);
+					current = current.then(current);
+				}
+				return result;
+			}
+		};
+
+		constexpr lcg_affine lcg_step{ 0x5DEECE66Dull, 0xBull };
+
+		// random_t keeps its seed private, its only data member
+		static_assert(sizeof(random_t) == sizeof(unsigned long long) && std::is_trivially_copyable_v<random_t>,
+			"unexpected layout of testlib random_t");
+
+		unsigned long long load_rnd_seed(const random_t& source)
+		{
+			unsigned long long seed;
+			std::memcpy(&seed, &source, sizeof(seed));
+			return seed;
+		}
+
+		void store_rnd_seed(random_t& target, unsigned long long seed)
+		{
+			std::memcpy(static_cast<void*>(&target), &seed, sizeof(seed));
+		}
+
+		// stream of the values random_t::nextBits(Bits) of the global rnd would return.
+		// values are generated in blocks by several independent generator states,
+		// rnd is advanced only by the consumed values when the stream is destroyed.
+		template<int Bits>
+		class rnd_bits_stream
+		{
+			static_assert(Bits == 31 || Bits == 63, "only 31 and 63 bits are supported");
+
+		public:
+			rnd_bits_stream() : _seed(load_rnd_seed(rnd)) {}
+			rnd_bits_stream(const rnd_bits_stream&) = delete;
+			rnd_bits_stream& operator=(const rnd_bits_stream&) = delete;
+			~rnd_bits_stream() { store_rnd_seed(rnd, lcg_step.pow(_pos * steps).apply(_seed)); }
+
+			unsigned long long next()
+			{
+				if (_pos == _size) _refill();
+				return _buffer[_pos++];
+			}
+
+			// returns unconsumed values of the current block, at least one, mark them used by skip
+			const unsigned long long* block(size_t& count)
+			{
+				if (_pos == _size) _refill();
+				count = _size - _pos;
+				return _buffer + _pos;
+			}
+
+			void skip(size_t count) { _pos += count; }
+
+		private:
+			static constexpr size_t block_size = 64;
+			// generator steps per value: 63 bits are glued from two steps
+			static constexpr size_t steps = Bits == 63 ? 2 : 1;
+			static constexpr size_t lanes = 8;
+
+			unsigned long long _seed;
+			size_t _pos = 0;
+			size_t _size = 0;
+			unsigned long long _buffer[block_size];
+
+			void _refill()
+			{
+				constexpr lcg_affine blockJump = lcg_step.pow(block_size * steps);
+				if (_size) _seed = blockJump.apply(_seed);
+				_fill(std::make_index_sequence<lanes>());
+				_pos = 0;
+				_size = block_size;
+			}
+
+			// lanes are unrolled, so the states stay in registers and their multiplications overlap
+			template<size_t... Lane>
+			void _fill(std::index_sequence<Lane...>)
+			{
+				constexpr lcg_affine laneJump = lcg_step.pow(lanes);
+				unsigned long long seed = _seed;
+				unsigned long long states[lanes] = { ((void)Lane, seed = lcg_step.apply(seed))... };
+
+				// the lower half of 63 bits has 31 bits in the generator version 0 and 32 bits otherwise
+				const int lowShift = random_t::version == 0 ? 17 : 16;
+				for (size_t i = 0; i < block_size; i += lanes / steps)
+				{
+					if constexpr (Bits == 31)
+					{
+						((_buffer[i + Lane] = states[Lane] >> 17), ...);
+					}
+					else
+					{
+						((Lane % 2 == 0 ? void(_buffer[i + Lane / 2] = ((states[Lane] >> 17) << 32) ^ (states[Lane + 1] >> lowShift)) : void()), ...);
+					}
+					((states[Lane] = laneJump.apply(states[Lane])), ...);
+				}
+			}
+		};
+
+		// random_t::next(n) for a fixed n on a stream of bits, remainders are taken without division
+		template<int Bits>
+		class rnd_bounded
+		{
+		public:
+			explicit rnd_bounded(unsigned long long n)
+				: _n(n),
+				_limit(Bits == 31 ? INT_MAX / n * n : LLONG_MAX / n * n),
+				_reduction(n),
+				_pow2(Bits == 31 && (n & (n - 1)) == 0)
+			{
+			}
+
+			// n for which random_t::next(n) succeeds for all integer types taking this path
+			static bool valid(unsigned long long n)
+			{
+				return n >= 1 && n < (Bits == 31 ? (unsigned long long)INT_MAX : (unsigned long long)LLONG_MAX);
+			}
+
+			unsigned long long operator()(rnd_bits_stream<Bits>& bits) const
+			{
+				unsigned long long value = bits.next();
+				if (_pow2) return (_n * value) >> 31;
+				while (value >= _limit) value = bits.next();
+				return _reduction.reduce(value);
+			}
+
+			// assigns map(draw) to [first; last), the same as a loop of operator() but a block at once
+			template<typename TIt, typename TMap>
+			void fill(rnd_bits_stream<Bits>& bits, TIt first, TIt last, TMap map) const
+			{
+				while (first != last)
+				{
+					size_t count;
+					const unsigned long long* block = bits.block(count);
+					size_t used = 0;
+					if (_pow2)
+					{
+						for (; used < count && first != last; ++used, ++first) *first = map((_n * block[used]) >> 31);
+					}
+					else
+					{
+						for (; used < count && first != last; ++used)
+						{
+							if (block[used] >= _limit) continue;
+							*first = map(_reduction.reduce(block[used]));
+							++first;
+						}
+					}
+					bits.skip(used);
+				}
+			}
+
+		private:
+			unsigned long long _n;
+			unsigned long long _limit;
+			barrett_reduction _reduction;
+			bool _pow2;
+		};
+
+		// hints the cache to load the line of address, for random accesses whose addresses are known in advance
+		void prefetch(const void* address)
+		{
+#if defined(__GNUC__)
+			__builtin_prefetch(address);
+#elif defined(PROBLIB_SIMD_SSE2)
+			_mm_prefetch(static_cast<const char*>(address), _MM_HINT_T0);
+#else
+			(void)address;
+#endif
+		}
+
+		// set of non-negative integers with open addressing and linear probing, for a known maximum number of values
+		class offset_set
+		{
+		public:
+			explicit offset_set(size_t capacity, double maxLoad = 0.5)
+			{
+				size_t size = 16;
+				for (_shift = 60; double(size) * maxLoad < double(capacity); --_shift) size *= 2;
+				_slots.assign(size, -1);
+			}
+
+			// returns false if value is already in the set
+			bool insert(long long value)
+			{
+				size_t i = _find(value);
+				if (_slots[i] == value) return false;
+				_slots[i] = value;
+				return true;
+			}
+
+			bool contains(long long value) const { return _slots[_find(value)] == value; }
+
+			void prefetch(long long value) const { impl::prefetch(&_slots[_home(value)]); }
+
+			// returns false if value is not in the set.
+			// following values of the probe sequence are shifted back, so no tombstones are left.
+			bool erase(long long value)
+			{
+				size_t i = _find(value);
+				if (_slots[i] != value) return false;
+				size_t mask = _slots.size() - 1;
+				for (size_t j = (i + 1) & mask; _slots[j] >= 0; j = (j + 1) & mask)
+				{
+					// the value at j can move to i if its home slot is not in (i; j]
+					if (((j - _home(_slots[j])) & mask) >= ((j - i) & mask))
+					{
+						_slots[i] = _slots[j];
+						i = j;
+					}
+				}
+				_slots[i] = -1;
+				return true;
+			}
+
+			// moves the values out in the order of slots, the set is empty afterwards.
+			// values are compacted in place, the memory of the slots is reused.
+			std::vector<long long> release()
+			{
+				std::vector<long long> values = std::move(_slots);
+				_slots.clear();
+				size_t count = 0;
+				for (long long value : values)
+				{
+					if (value >= 0) values[count++] = value;
+				}
+				values.resize(count);
+				return values;
+			}
+
+		private:
+			std::vector<long long> _slots;
+			// 64 - log2 of the number of slots
+			int _shift;
+
+			// the top bits of the product depend on all bits of value
+			size_t _home(long long value) const
+			{
+				return size_t((static_cast<unsigned long long>(value) * 0x9E3779B97F4A7C15ull) >> _shift);
+			}
+
+			// returns the slot of value or the empty slot where it would be inserted
+			size_t _find(long long value) const
+			{
+				size_t mask = _slots.size() - 1;
+				size_t i = _home(value);
+				while (_slots[i] >= 0 && _slots[i] != value) i = (i + 1) & mask;
+				return i;
+			}
+		};
+
+		// sorts values from [0; count) in expected linear time if they are spread uniformly.
+		// values are distributed over buckets by a monotonic estimate of their rank and sorted inside buckets.
+		void sort_uniform(std::vector<long long>& values, long long count)
+		{
+			size_t n = values.size();
+			if (n < 2) return;
+			double scale = double(n) / double(count);
+			auto bucket = [&](long long value) { return std::min(size_t(double(value) * scale), n - 1); };
+
+			std::vector<size_t> starts(n + 1, 0);
+			for (long long value : values) ++starts[bucket(value) + 1];
+			std::partial_sum(starts.begin(), starts.end(), starts.begin());
+			std::vector<long long> sorted(n);
+			for (long long value : values) sorted[starts[bucket(value)]++] = value;
+
+			// buckets are in order now, each holds O(1) values on average
+			for (size_t i = 1; i < n; ++i)
+			{
+				long long value = sorted[i];
+				size_t j = i;
+				for (; j > 0 && sorted[j - 1] > value; --j) sorted[j] = sorted[j - 1];
+				sorted[j] = value;
+			}
+			values = std::move(sorted);
+		}
+
+		// integer types for which rnd.next(from, to) draws rnd.next(to - from + 1) on 63 bits
+		template<typename T>
+		constexpr bool is_batch_rnd_v = str::impl::is_fast_integral_v<T> && sizeof(T) >= sizeof(int);
+
+		// length of [from; to] as rnd.next(from, to) takes it, valid only if from <= to
+		template<typename T>
+		unsigned long long rnd_length(T from, T to)
+		{
+			return static_cast<unsigned long long>(to) - static_cast<unsigned long long>(from) + 1;
+		}
+
+		template<typename T>
+		T rnd_offset(T from, unsigned long long offset)
+		{
+			if constexpr (std::is_signed_v<T>) return T(static_cast<long long>(from) + static_cast<long long>(offset));
+			else return T(static_cast<unsigned long long>(from) + offset);
+		}
+	}
+
+	// testlib random_t which can jump ahead: discard(k) advances it by k generator steps in O(log k).
+	// each nextBits call takes one step, two for more than 31 bits, so next(n) of a power of two int takes one step.
+	// stream(i) starts stream_steps * i steps later, so streams do not overlap while each takes at most stream_steps steps,
+	// generating item i of a test from stream(i) gives the same result in any order and in any process.
+	class random_stream
+	{
+	public:
+		static constexpr unsigned long long stream_steps = 1ull << 36;
+		static constexpr unsigned long long stream_count = (impl::lcg_affine::mask + 1) / stream_steps;
+
+		// copies the current state of rnd
+		random_stream() : random_stream(rnd) {}
+		explicit random_stream(const random_t& source) : _rnd(source) {}
+
+		random_t& get() { return _rnd; }
+		const random_t& get() const { return _rnd; }
+		random_t& operator*() { return _rnd; }
+		random_t* operator->() { return &_rnd; }
+
+		random_stream& discard(unsigned long long steps)
+		{
+			_jump(impl::lcg_step.pow(steps));
+			return *this;
+		}
+
+		random_stream stream(unsigned long long index) const
+		{
+			if (index >= stream_count) throw std::out_of_range("random stream index is too large");
+			random_stream result = *this;
+			return result.discard(stream_steps * index);
+		}
+
+		// returns this stream and moves to the next one
+		random_stream split()
+		{
+			random_stream result = *this;
+			_jump(_stream_jump);
+			return result;
+		}
+
+		// sets the global rnd to this state, so problib and testlib functions draw from it
+		void make_current() const { rnd = _rnd; }
+
+		bool operator==(const random_stream& other) const { return impl::load_rnd_seed(_rnd) == impl::load_rnd_seed(other._rnd); }
+		bool operator!=(const random_stream& other) const { return !(*this == other); }
+
+	private:
+		static constexpr impl::lcg_affine _stream_jump = impl::lcg_step.pow(stream_steps);
+
+		random_t _rnd;
+
+		void _jump(const impl::lcg_affine& jump) { impl::store_rnd_seed(_rnd, jump.apply(impl::load_rnd_seed(_rnd))); }
+	};
+
+#pragma endregion
+#endif
+
+#ifdef _TESTLIB_H_
+#pragma region patterns
+
+	namespace impl
+	{
+		// tree of testlib pattern in a flat form: the same nodes testlib pattern builds, in preorder.
+		// a node is chars repeated [from; to] times followed by one of the children.
+		class pattern_tree
+		{
+		public:
+			struct node
+			{
+				size_t chars_begin, chars_end;
+				int from, to;
+				size_t children_begin, children_end;
+			};
+
+			explicit pattern_tree(const std::string& source) { _parse(source); }
+
+			const node& operator[](size_t index) const { return _nodes[index]; }
+			size_t size() const { return _nodes.size(); }
+			// chars of a node are sorted
+			std::string_view chars(const node& n) const { return std::string_view(_chars).substr(n.chars_begin, n.chars_end - n.chars_begin); }
+			size_t child(const node& n, size_t index) const { return _children[n.children_begin + index]; }
+			size_t children_count(const node& n) const { return n.children_end - n.children_begin; }
+
+		private:
+			std::vector<node> _nodes;
+			std::string _chars;
+			std::vector<size_t> _children;
+
+			[[noreturn]] static void _fail(const std::string& s)
+			{
+				throw std::invalid_argument("pattern: Illegal pattern (or part) \"" + s + "\"");
+			}
+
+			static bool _is_command_char(const std::string& s, size_t pos, char value)
+			{
+				if (pos >= s.length()) return false;
+				int slashes = 0;
+				for (int before = int(pos) - 1; before >= 0 && s[before] == '\\'; --before) ++slashes;
+				return slashes % 2 == 0 && s[pos] == value;
+			}
+
+			static char _get_char(const std::string& s, size_t& pos)
+			{
+				pos += s[pos] == '\\' ? 2 : 1;
+				return s[pos - 1];
+			}
+
+			static void _scan_counts(const std::string& s, size_t& pos, int& from, int& to)
+			{
+				from = to = 1;
+				if (pos >= s.length()) return;
+
+				if (_is_command_char(s, pos, '{'))
+				{
+					std::vector<std::string> parts;
+					std::string part;
+					for (++pos; pos < s.length() && !_is_command_char(s, pos, '}');)
+					{
+						if (_is_command_char(s, pos, ',')) parts.push_back(part), part = "", ++pos;
+						else part += _get_char(s, pos);
+					}
+					if (part != "") parts.push_back(part);
+					if (!_is_command_char(s, pos, '}') || parts.size() < 1 || parts.size() > 2) _fail(s);
+					++pos;
+
+					int numbers[2];
+					for (size_t i = 0; i < parts.size(); ++i)
+					{
+						if (parts[i].empty() || std::sscanf(parts[i].c_str(), "%d", &numbers[i]) != 1) _fail(s);
+					}
+					from = numbers[0];
+					to = numbers[parts.size() - 1];
+					if (from > to) _fail(s);
+				}
+				else if (_is_command_char(s, pos, '?')) from = 0, to = 1, ++pos;
+				else if (_is_command_char(s, pos, '*')) from = 0, to = INT_MAX, ++pos;
+				else if (_is_command_char(s, pos, '+')) from = 1, to = INT_MAX, ++pos;
+			}
+
+			static std::string _scan_char_set(const std::string& s, size_t& pos)
+			{
+				if (pos >= s.length()) _fail(s);
+				if (!_is_command_char(s, pos, '[')) return std::string(1, _get_char(s, pos));
+
+				std::string result;
+				++pos;
+				bool negative = _is_command_char(s, pos, '^');
+				char prev = 0;
+				while (pos < s.length() && !_is_command_char(s, pos, ']'))
+				{
+					if (_is_command_char(s, pos, '-') && prev != 0)
+					{
+						++pos;
+						if (pos + 1 == s.length() || _is_command_char(s, pos, ']'))
+						{
+							result.push_back(prev);
+							prev = '-';
+							continue;
+						}
+						char next = _get_char(s, pos);
+						if (prev > next) _fail(s);
+						for (char c = prev; c != next; ++c) result.push_back(c);
+						result.push_back(next);
+						prev = 0;
+					}
+					else
+					{
+						if (prev != 0) result.push_back(prev);
+						prev = _get_char(s, pos);
+					}
+				}
+				if (prev != 0) result.push_back(prev);
+				if (!_is_command_char(s, pos, ']')) _fail(s);
+				++pos;
+
+				std::sort(result.begin(), result.end());
+				if (negative)
+				{
+					// as testlib, char 255 is never in a negated set
+					std::string actuals;
+					for (int code = 0; code < 255; ++code)
+					{
+						if (!std::binary_search(result.begin(), result.end(), char(code))) actuals.push_back(char(code));
+					}
+					result = actuals;
+					std::sort(result.begin(), result.end());
+				}
+				return result;
+			}
+
+			size_t _parse(const std::string& source)
+			{
+				std::string s;
+				for (size_t i = 0; i < source.length(); ++i)
+				{
+					if (!_is_command_char(source, i, ' ')) s += source[i];
+				}
+
+				int opened = 0;
+				int firstClose = -1;
+				std::vector<size_t> seps;
+				for (size_t i = 0; i < s.length(); ++i)
+				{
+					if (_is_command_char(s, i, '('))
+					{
+						++opened;
+						continue;
+					}
+					if (_is_command_char(s, i, ')'))
+					{
+						--opened;
+						if (opened == 0 && firstClose == -1) firstClose = int(i);
+						continue;
+					}
+					if (opened < 0) _fail(s);
+					if (_is_command_char(s, i, '|') && opened == 0) seps.push_back(i);
+				}
+				if (opened != 0) _fail(s);
+
+				size_t index = _nodes.size();
+				_nodes.push_back(node{ _chars.size(), _chars.size(), 0, 0, 0, 0 });
+				std::vector<size_t> children;
+				if (seps.empty() && firstClose + 1 == int(s.length()) && _is_command_char(s, 0, '(') && _is_command_char(s, s.length() - 1, ')'))
+				{
+					children.push_back(_parse(s.substr(1, s.length() - 2)));
+				}
+				else if (!seps.empty())
+				{
+					seps.push_back(s.length());
+					size_t last = 0;
+					for (size_t sep : seps)
+					{
+						children.push_back(_parse(s.substr(last, sep - last)));
+						last = sep + 1;
+					}
+				}
+				else
+				{
+					size_t pos = 0;
+					std::string chars = _scan_char_set(s, pos);
+					_nodes[index].chars_begin = _chars.size();
+					_chars += chars;
+					_nodes[index].chars_end = _chars.size();
+					_scan_counts(s, pos, _nodes[index].from, _nodes[index].to);
+					if (pos < s.length()) children.push_back(_parse(s.substr(pos)));
+				}
+
+				_nodes[index].children_begin = _children.size();
+				_children.insert(_children.end(), children.begin(), children.end());
+				_nodes[index].children_end = _children.size();
+				return index;
+			}
+		};
+	}
+
+	// testlib pattern parsed once. generates the same strings as rnd.next(pattern) with the same draws of rnd,
+	// appending to a buffer without allocations per node.
+	// matches accepts the same strings as pattern::matches.
+	class compiled_pattern
+	{
+	public:
+		explicit compiled_pattern(const std::string& source) : _source(source), _tree(source)
+		{
+			for (size_t i = 0; i < _tree.size(); ++i)
+			{
+				const auto& n = _tree[i];
+				bool counted = n.to > 0 && n.to != INT_MAX;
+				_bounds.push_back(_node_bounds{
+					_bound(counted ? (unsigned long long)((long long)n.to - n.from + 1) : 1),
+					_bound(n.chars_end - n.chars_begin),
+					_bound(_tree.children_count(n)) });
+				_classes.emplace_back(_tree.chars(n));
+			}
+		}
+
+		const std::string& src() const { return _source; }
+
+		// testlib matching is greedy: a node takes the longest run of its chars up to `to` and never gives chars back,
+		// so the offset of a node is fixed by its parent and every node is scanned at most once.
+		// runs are scanned by str::char_class, with SIMD for classes of a few ranges.
+		bool matches(std::string_view s) const
+		{
+			std::vector<std::pair<size_t, size_t>> pending;
+			for (size_t index = 0, pos = 0; ; )
+			{
+				const auto& n = _tree[index];
+				bool failed = false;
+				if (n.to > 0)
+				{
+					size_t limit = s.size() - pos > size_t(n.to) ? pos + size_t(n.to) : s.size();
+					size_t end = _classes[index].find_first_not(s.substr(0, limit), pos);
+					if (end == std::string_view::npos) end = limit;
+					failed = end - pos < size_t(n.from);
+					pos = end;
+				}
+
+				size_t children = _tree.children_count(n);
+				if (!failed && children == 0 && pos == s.size()) return true;
+				if (!failed && children > 0)
+				{
+					// alternatives are tried in testlib order, the first one right away
+					for (size_t child = children - 1; child > 0; --child) pending.emplace_back(_tree.child(n, child), pos);
+					index = _tree.child(n, 0);
+					continue;
+				}
+				if (pending.empty()) return false;
+				std::tie(index, pos) = pending.back();
+				pending.pop_back();
+			}
+		}
+
+		std::string get_rnd() const
+		{
+			std::string result;
+			append_rnd(result);
+			return result;
+		}
+
+		void append_rnd(std::string& out) const
+		{
+			impl::rnd_bits_stream<31> bits;
+			_append(bits, out);
+		}
+
+		std::vector<std::string> get_rnd_n(size_t count) const
+		{
+			std::vector<std::string> result(count);
+			impl::rnd_bits_stream<31> bits;
+			for (auto& value : result) _append(bits, value);
+			return result;
+		}
+
+	private:
+		using _bounded = impl::rnd_bounded<31>;
+
+		// random_t::next(n) for the count, the char and the child of a node
+		struct _node_bounds
+		{
+			_bounded count, char_index, child;
+		};
+
+		std::string _source;
+		impl::pattern_tree _tree;
+		std::vector<_node_bounds> _bounds;
+		std::vector<str::char_class> _classes;
+
+		static _bounded _bound(unsigned long long n)
+		{
+			if (n > (unsigned long long)INT_MAX) throw std::invalid_argument("pattern: counts are too large");
+			// empty sets are failed on use as by testlib
+			return _bounded(n ? n : 1);
+		}
+
+		void _append(impl::rnd_bits_stream<31>& bits, std::string& out) const
+		{
+			for (size_t index = 0; ; )
+			{
+				const auto& n = _tree[index];
+				const auto& bounds = _bounds[index];
+				if (n.to == INT_MAX) throw std::invalid_argument("pattern: can't process character '*' for generation");
+				if (n.to > 0)
+				{
+					int count = int(bounds.count(bits)) + n.from;
+					auto chars = _tree.chars(n);
+					if (count > 0 && chars.empty()) throw std::invalid_argument("pattern: empty set of chars for generation");
+					for (int i = 0; i < count; ++i) out += chars[bounds.char_index(bits)];
+				}
+				if (!_tree.children_count(n)) break;
+				index = _tree.child(n, bounds.child(bits));
+			}
+		}
+	};
+
+	namespace impl
+	{
+		// message of testlib readWord / readLine for a value mismatching the pattern,
+		// what is "Token" or "Line", readManyIteration is InStream::NO_INDEX outside of readTokens / readLines
+		std::string pattern_mismatch_message(const std::string& what, int readManyIteration, const std::string& value, const compiled_pattern& p, const std::string& variableName)
+		{
+			// a named token is a "Token parameter", a named line is just a "Line"
+			if (readManyIteration == InStream::NO_INDEX)
+			{
+				if (variableName.empty()) return what + " \"" + __testlib_part(value) + "\" doesn't correspond to pattern \"" + p.src() + "\"";
+				return what + (what == "Token" ? " parameter" : "") + " [name=" + variableName + "] equals to \"" + __testlib_part(value)
+					+ "\", doesn't correspond to pattern \"" + p.src() + "\"";
+			}
+			if (variableName.empty())
+			{
+				return what + " element [index=" + vtos(readManyIteration) + "] equals to \"" + __testlib_part(value) + "\" doesn't correspond to pattern \"" + p.src() + "\"";
+			}
+			return what + " element " + variableName + "[" + vtos(readManyIteration) + "] equals to \"" + __testlib_part(value)
+				+ "\", doesn't correspond to pattern \"" + p.src() + "\"";
+		}
+
+		// quits the stream with the message of testlib readWord / readLine for a mismatch
+		void quit_pattern_mismatch(InStream& in, const char* what, const std::string& value, const compiled_pattern& p, const std::string& variableName)
+		{
+			in.quit(_wa, pattern_mismatch_message(what, in.readManyIteration, value, p, variableName).c_str());
+		}
+	}
+
+	// the same as in.readToken(pattern, variableName) of testlib with a pattern compiled once
+	std::string read_token(InStream& in, const compiled_pattern& p, const std::string& variableName = "")
+	{
+		in.readWordTo(in._tmpReadToken);
+		if (!p.matches(in._tmpReadToken)) impl::quit_pattern_mismatch(in, "Token", in._tmpReadToken, p, variableName);
+		return in._tmpReadToken;
+	}
+
+	// the same as in.readLine(pattern, variableName) of testlib with a pattern compiled once
+	std::string read_line(InStream& in, const compiled_pattern& p, const std::string& variableName = "")
+	{
+		in.readStringTo(in._tmpReadToken);
+		if (!p.matches(in._tmpReadToken)) impl::quit_pattern_mismatch(in, "Line", in._tmpReadToken, p, variableName);
+		return in._tmpReadToken;
+	}
+
+#pragma endregion
+#endif
+
+#pragma region ranges
+
+	// struct for integer range [from; to] and for floating range [from; to) 
+	template<typename T>
+	struct range
+	{
+		using value_type = T;
+		value_type from;
+		value_type to;
+
+		range() = default;
+		constexpr range(value_type fromto) : from(fromto), to(fromto) {}
+		constexpr range(value_type from, value_type to) : from(from), to(to) {}
+
+		value_type length() const;
+
+#ifdef _TESTLIB_H_
+		// returns random value in [form; to].
+		// for floating range: [from; to)
+		value_type get_rnd() const { return rnd.next(from, to); }
+
+		// returns random value in intersection of [form; to] and [lowerBound; upperBound].
+		// for floating range: [form; to) and [lowerBound; upperBound)
+		value_type get_rnd(value_type lowerBound, value_type upperBound) const
+		{
+			assert(lowerBound <= upperBound);
+			return rnd.next(
+				bound_value(lowerBound, upperBound, from),
+				bound_value(lowerBound, upperBound, to)
+			);
+		}
+
+		// fills [first; last) with random values, the same as assigning get_rnd() to the elements in order
+		template<typename TIt>
+		void fill_rnd(TIt first, TIt last) const
+		{
+			if constexpr (impl::is_batch_rnd_v<value_type>)
+			{
+				if (from <= to && impl::rnd_bounded<63>::valid(impl::rnd_length(from, to)))
+				{
+					impl::rnd_bits_stream<63> bits;
+					impl::rnd_bounded<63>(impl::rnd_length(from, to)).fill(bits, first, last,
+						[from = from](unsigned long long offset) { return impl::rnd_offset(from, offset); });
+					return;
+				}
+			}
+			for (; first != last; ++first) *first = get_rnd();
+		}
+
+		// returns n random values, the same as n calls of get_rnd()
+		std::vector<value_type> get_rnd_n(size_t n) const
+		{
+			std::vector<value_type> result(n);
+			fill_rnd(result.begin(), result.end());
+			return result;
+		}
+#endif
+	};
+
+	template<typename T> T range<T>::length() const { return to - from + 1; }
+	template<> double range<double>::length() const { return to - from; }
+	template<> float range<float>::length() const { return to - from; }
+
+	template<typename T>
+	constexpr range<T> make_range(T from, T to)
+	{
+		return range<T>(from, to);
+	}
+
+	enum class range_random_mode
+	{
+		uniform_by_length,
+		uniform_by_count,
+		// ranges are picked with probabilities proportional to their weights
+		weighted,
+	};
+
+	// distribution of values within the sampled domain: the concatenation of ranges
+	// for uniform_by_length and the picked range otherwise.
+	// offsets from the start of the domain are drawn by inversion in O(1), see distribution_parameter.
+	enum class range_distribution
+	{
+		uniform,
+		// like testlib wnext(n, type): the maximum of type + 1 uniform values for positive type,
+		// the minimum of 1 - type values for negative type
+		skewed,
+		// offset k has probability proportional to 1 / (k + 1)^s, integers only
+		zipf,
+		// offset k has probability proportional to (1 - p)^k, integers only
+		geometric,
+	};
+
+	struct range_array_opts
+	{
+		range_random_mode random_mode = range_random_mode::uniform_by_length;
+		range_distribution distribution = range_distribution::uniform;
+		// type for skewed, exponent s > 0 for zipf, success probability p in (0, 1] for geometric
+		double distribution_parameter = 0;
+	};
+
+	template<typename T>
+	class range_array_values;
+
+	template<typename T>
+	class range_array
+	{
+	public:
+		using value_type = T;
+		using range_type = range<value_type>;
+
+		range_array() = default;
+		range_array(const range_type& range) : _vals(1, range) { }
+		explicit range_array(const range_array_opts& opts) : _opts(opts) {}
+
+		// mutable access drops the cached clipped array of get_rnd(lowerBound, upperBound)
+		range_array_opts& options()
+		{
+			_clipped.reset();
+			return _opts;
+		}
+		const range_array_opts& options() const { return _opts; }
+
+		void push_back(const range_type& value)
+		{
+			_vals.push_back(value);
+			if (!_weights.empty()) _weights.push_back(1);
+			_invalidate_index();
+		}
+
+		// appends range with weight for range_random_mode::weighted
+		void push_back(const range_type& value, double weight)
+		{
+			if (!_weights.empty() || weight != 1)
+			{
+				_weights.resize(_vals.size(), 1);
+				_weights.push_back(weight);
+			}
+			_vals.push_back(value);
+			_invalidate_index();
+		}
+
+		size_t size() const { return _vals.size(); }
+
+		// weight of the range for range_random_mode::weighted, 1 by default
+		double weight(size_t index) const { return _weights.empty() ? 1 : _weights[index]; }
+
+		value_type total_length() const
+		{
+			_ensure_index();
+			return _total;
+		}
+
+		const range_type& operator[](size_t index) const { return _vals[index]; }
+
+		// mutable access drops the sampling index, it is rebuilt on the next draw
+		range_type& operator[](size_t index)
+		{
+			_invalidate_index();
+			return _vals[index];
+		}
+
+		// lazy view of the values, see range_array_values
+		template<typename U = value_type, typename = std::enable_if_t<std::is_integral<U>::value>>
+		range_array_values<U> values() const { return range_array_values<U>(*this); }
+
+		template<typename U = value_type, typename = std::enable_if_t<std::is_integral<U>::value>>
+		std::vector<value_type> get_all_values() const
+		{
+			auto result = std::vector<value_type>();
+			for (const auto& val : _vals)
+			{
+				for (value_type current = val.from; current <= val.to; ++current)
+				{
+					result.push_back(current);
+				}
+			}
+			return result;
+		}
+
+#ifdef _TESTLIB_H_
+		// returns random value in range array
+		value_type get_rnd() const;
+
+		// returns random value in array of intersections with [lowerBound, upperBound].
+		// uniform_by_length and uniform_by_count arrays with the uniform distribution draw the same values
+		// as the former clipped copy for the same seed. weighted arrays and other distributions keep
+		// the distribution of get_rnd() over the clipped ranges, but not its sequence of draws.
+		value_type get_rnd(value_type lowerBound, value_type upperBound) const;
+
+		// fills [first; last) with random values, the same as assigning get_rnd() to the elements in order.
+		// the sampling state is prepared once for all values.
+		template<typename TIt>
+		void fill_rnd(TIt first, TIt last) const;
+
+		// returns n random values, the same as n calls of get_rnd()
+		std::vector<value_type> get_rnd_n(size_t n) const
+		{
+			std::vector<value_type> result(n);
+			fill_rnd(result.begin(), result.end());
+			return result;
+		}
+
+		// returns n distinct random values, see range_set::sample_distinct.
+		// overlapping ranges are merged, so every value is equally likely regardless of the random mode.
+		template<typename U = value_type, typename = std::enable_if_t<std::is_integral<U>::value>>
+		std::vector<value_type> sample_distinct(size_t n, bool sorted = true) const;
+#endif
+
+	private:
+		friend class range_array_values<value_type>;
+
+		range_array_opts _opts;
+		std::vector<range_type> _vals;
+		// empty if all weights are 1
+		std::vector<double> _weights;
+
+		// lazily built sampling index: _starts[i] is the offset of the first value of _vals[i]
+		// in the concatenation of all ranges, _total is the length of the concatenation.
+		// offsets are computed by subtracting lengths from the total backwards,
+		// so floating offsets are bitwise the same as in the former linear scan.
+		// _ordered is set if ranges are non-empty, sorted and disjoint.
+		mutable std::vector<value_type> _starts;
+		mutable value_type _total = value_type(0);
+		mutable bool _ordered = false;
+		mutable bool _indexed = false;
+
+		// Vose alias table over the weights: range i is kept with probability _alias_prob[i]
+		// and replaced by _alias[i] otherwise
+		mutable std::vector<double> _alias_prob;
+		mutable std::vector<size_t> _alias;
+		mutable bool _alias_built = false;
+		// prefix sums of the weights, built with the alias table: _weight_sums[i] is the sum of weights before range i
+		mutable std::vector<double> _weight_sums;
+
+		// clipped array of the last bounds of get_rnd(lowerBound, upperBound) for unordered ranges
+		mutable std::shared_ptr<const range_array> _clipped;
+		mutable value_type _clipped_lower = value_type(0);
+		mutable value_type _clipped_upper = value_type(0);
+
+		void _invalidate_index()
+		{
+			_indexed = false;
+			_alias_built = false;
+			_clipped.reset();
+		}
+
+#ifdef _TESTLIB_H_
+		void _ensure_alias() const
+		{
+			if (_alias_built) return;
+			size_t n = _vals.size();
+			double sum = 0;
+			for (size_t i = 0; i < n; ++i)
+			{
+				ensuref(weight(i) >= 0, "Range weights must be non-negative.");
+				sum += weight(i);
+			}
+			ensuref(sum > 0, "Sum of range weights must be positive.");
+
+			_alias_prob.resize(n);
+			_alias.resize(n);
+			std::vector<size_t> small, large;
+			for (size_t i = 0; i < n; ++i)
+			{
+				_alias_prob[i] = weight(i) * double(n) / sum;
+				_alias[i] = i;
+				(_alias_prob[i] < 1 ? small : large).push_back(i);
+			}
+			while (!small.empty() && !large.empty())
+			{
+				size_t less = small.back(), more = large.back();
+				small.pop_back();
+				_alias[less] = more;
+				_alias_prob[more] -= 1 - _alias_prob[less];
+				if (_alias_prob[more] < 1)
+				{
+					large.pop_back();
+					small.push_back(more);
+				}
+			}
+			// leftovers are 1 up to rounding errors
+			for (size_t i : small) _alias_prob[i] = 1;
+			for (size_t i : large) _alias_prob[i] = 1;
+			_weight_sums.resize(n + 1);
+			_weight_sums[0] = 0;
+			for (size_t i = 0; i < n; ++i) _weight_sums[i + 1] = _weight_sums[i] + weight(i);
+			_alias_built = true;
+		}
+#endif
+
+		void _ensure_index() const
+		{
+			if (_indexed) return;
+			_total = std::accumulate(
+				_vals.begin(),
+				_vals.end(),
+				value_type(0),
+				[](value_type current, const range_type & val) { return current + val.length(); }
+			);
+			_starts.resize(_vals.size());
+			value_type length = _total;
+			for (auto i = ptrdiff_t(_vals.size()) - 1; i >= 0; --i)
+			{
+				length -= _vals[i].length();
+				_starts[i] = length;
+			}
+			_ordered = true;
+			for (size_t i = 0; i < _vals.size(); ++i)
+			{
+				if (_vals[i].to < _vals[i].from || (i > 0 && !(_vals[i - 1].to < _vals[i].from))) _ordered = false;
+			}
+			_indexed = true;
+		}
+
+		// returns index of the range containing value with the given offset in the concatenation of all ranges
+		size_t _find_by_offset(value_type offset) const
+		{
+			auto it = std::upper_bound(_starts.begin(), _starts.end(), offset);
+			return it == _starts.begin() ? 0 : size_t(it - _starts.begin() - 1);
+		}
+
+		// returns value with the given offset in the concatenation of all ranges
+		value_type _value_by_offset(value_type offset) const
+		{
+			size_t i = _find_by_offset(offset);
+			if (offset < _starts[i]) return _vals[0].from;
+			return _vals[i].from + (offset - _starts[i]);
+		}
+
+		value_type _draw_offset(value_type length) const;
+		size_t _draw_range_index() const;
+		value_type _get_rnd_distributed() const;
+		value_type _get_rnd_distributed_in_range(value_type minVal, value_type maxVal) const;
+		value_type _get_rnd_uniform_by_values() const;
+		value_type _get_rnd_in_range_uniform_by_values(value_type minVal, value_type maxVal) const;
+		value_type _get_rnd_in_empty_range(value_type minVal, value_type maxVal) const;
+		value_type _get_rnd_uniform_by_count() const;
+		value_type _get_rnd_in_range_uniform_by_count(value_type minVal, value_type maxVal) const;
+	};
+
+
+	// lazy view of all values of a range array in the order of get_all_values.
+	// takes constant memory regardless of the number of values, the array must outlive the view
+	// and must not be modified while the view is used.
+	template<typename T>
+	class range_array_values
+	{
+		static_assert(std::is_integral_v<T>, "range_array_values supports only integral values");
+
+	public:
+		using value_type = T;
+		using range_type = range<value_type>;
+
+		class iterator
+		{
+		public:
+			using iterator_category = std::forward_iterator_tag;
+			using value_type = T;
+			using difference_type = std::ptrdiff_t;
+			using pointer = const T*;
+			using reference = const T&;
+
+			iterator() : _vals(nullptr), _index(0), _current() {}
+
+			reference operator*() const { return _current; }
+			pointer operator->() const { return &_current; }
+
+			iterator& operator++()
+			{
+				if (_current == (*_vals)[_index].to)
+				{
+					++_index;
+					_skip_empty();
+				}
+				else
+				{
+					++_current;
+				}
+				return *this;
+			}
+
+			iterator operator++(int)
+			{
+				auto result = *this;
+				++*this;
+				return result;
+			}
+
+			bool operator==(const iterator& other) const { return _index == other._index && (_index == _size() || _current == other._current); }
+			bool operator!=(const iterator& other) const { return !(*this == other); }
+
+		private:
+			friend class range_array_values;
+
+			const range_array<T>* _vals;
+			size_t _index;
+			T _current;
+
+			iterator(const range_array<T>& vals, size_t index) : _vals(&vals), _index(index), _current() { _skip_empty(); }
+
+			size_t _size() const { return _vals ? _vals->size() : 0; }
+
+			void _skip_empty()
+			{
+				while (_index < _vals->size() && (*_vals)[_index].to < (*_vals)[_index].from) ++_index;
+				if (_index < _vals->size()) _current = (*_vals)[_index].from;
+			}
+		};
+
+		explicit range_array_values(const range_array<value_type>& vals) : _vals(vals) {}
+
+		// number of values
+		value_type size() const { return _vals.total_length(); }
+
+		// returns value with index k, O(log n)
+		value_type operator[](value_type k) const
+		{
+			_vals._ensure_index();
+			assert(k >= 0 && k < _vals._total);
+			size_t i = _vals._find_by_offset(k);
+			return _vals[i].from + (k - _vals._starts[i]);
+		}
+
+		iterator begin() const { return iterator(_vals, 0); }
+		iterator end() const { return iterator(_vals, _vals.size()); }
+
+		// writes count values starting from the one with index k to out, returns pointer past the last written.
+		// values are written range by range with a plain loop, so compilers vectorize it.
+		value_type* fill(value_type k, value_type* out, size_t count) const
+		{
+			if (!count) return out;
+			_vals._ensure_index();
+			assert(k >= 0 && k <= _vals._total && size_t(_vals._total - k) >= count);
+			size_t i = _vals._find_by_offset(k);
+			value_type offset = k - _vals._starts[i];
+			while (count > 0)
+			{
+				const range_type& current = _vals[i++];
+				if (current.to < current.from) continue;
+				size_t available = size_t(current.length() - offset);
+				size_t n = std::min(count, available);
+				const value_type first = current.from + offset;
+				for (size_t j = 0; j < n; ++j) out[j] = value_type(first + value_type(j));
+				out += n;
+				count -= n;
+				offset = value_type(0);
+			}
+			return out;
+		}
+
+	private:
+		const range_array<value_type>& _vals;
+	};
+
+#pragma region Rnd in range impl
+
+#ifdef _TESTLIB_H_
+
+	namespace impl
+	{
+		// returns k in [1; n] with probability proportional to 1 / k^s in O(1) expected time,
+		// the rejection-inversion method of Hormann and Derflinger
+		long long zipf_rejection_inversion(double s, double n)
+		{
+			auto helper1 = [](double x) { return std::abs(x) > 1e-8 ? std::log1p(x) / x : 1 - x * (0.5 - x * (1.0 / 3 - 0.25 * x)); };
+			auto helper2 = [](double x) { return std::abs(x) > 1e-8 ? std::expm1(x) / x : 1 + x * 0.5 * (1 + x / 3 * (1 + 0.25 * x)); };
+			auto h = [&](double x) { return std::exp(-s * std::log(x)); };
+			auto hIntegral = [&](double x) { double logX = std::log(x); return helper2((1 - s) * logX) * logX; };
+			auto hIntegralInverse = [&](double x)
+			{
+				double t = std::max(x * (1 - s), -1.0);
+				return std::exp(helper1(t) * x);
+			};
+
+			double hIntegralX1 = hIntegral(1.5) - 1;
+			double hIntegralN = hIntegral(n + 0.5);
+			double squeeze = 2 - hIntegralInverse(hIntegral(2.5) - h(2));
+			while (true)
+			{
+				double u = hIntegralN + rnd.next() * (hIntegralX1 - hIntegralN);
+				double x = hIntegralInverse(u);
+				double k = std::min(std::max(std::floor(x + 0.5), 1.0), n);
+				if (k - x <= squeeze || u >= hIntegral(k + 0.5) - h(k)) return static_cast<long long>(k);
+			}
+		}
+	}
+
+	template<typename T>
+	T range_array<T>::get_rnd() const
+	{
+		ensuref(!_vals.empty(), "Can not get rnd for empty range array.");
+		if (_opts.distribution != range_distribution::uniform) return _get_rnd_distributed();
+		if (_vals.size() == 1) return _vals[0].get_rnd();
+		switch (_opts.random_mode)
+		{
+		case range_random_mode::uniform_by_count:
+			return _get_rnd_uniform_by_count();
+		case range_random_mode::weighted:
+			return _vals[_draw_range_index()].get_rnd();
+		case range_random_mode::uniform_by_length:
+			return _get_rnd_uniform_by_values();
+		default:
+			ensuref(false, "Invalid range-random mode.");
+			throw;
+		}
+	}
+
+	template<typename T>
+	T range_array<T>::get_rnd(T lowerBound, T upperBound) const
+	{
+		ensuref(!_vals.empty(), "Can not get rnd for empty range array.");
+		if (_opts.random_mode == range_random_mode::weighted || _opts.distribution != range_distribution::uniform)
+		{
+			return _get_rnd_distributed_in_range(lowerBound, upperBound);
+		}
+		if (_vals.size() == 1) return _vals[0].get_rnd(lowerBound, upperBound);
+		switch (_opts.random_mode)
+		{
+		case range_random_mode::uniform_by_count:
+			return _get_rnd_in_range_uniform_by_count(lowerBound, upperBound);
+		case range_random_mode::uniform_by_length:
+			return _get_rnd_in_range_uniform_by_values(lowerBound, upperBound);
+		default:
+			ensuref(false, "Invalid range-random mode.");
+			throw;
+		}
+	}
+
+	template<typename T>
+	template<typename TIt>
+	void range_array<T>::fill_rnd(TIt first, TIt last) const
+	{
+		if (first == last) return;
+		ensuref(!_vals.empty(), "Can not get rnd for empty range array.");
+		if (_opts.distribution != range_distribution::uniform || _opts.random_mode == range_random_mode::weighted)
+		{
+			for (; first != last; ++first) *first = get_rnd();
+			return;
+		}
+		if (_vals.size() == 1) return _vals[0].fill_rnd(first, last);
+
+		// the same draws as get_rnd() in a loop: rnd.next(_vals.size()) is drawn on 63 bits,
+		// rnd.next(_total) on 31 bits for int and unsigned int totals and on 63 bits otherwise
+		if constexpr (impl::is_batch_rnd_v<value_type>)
+		{
+			if (_opts.random_mode == range_random_mode::uniform_by_count && impl::rnd_bounded<63>::valid(_vals.size()))
+			{
+				std::vector<impl::rnd_bounded<63>> bounds;
+				bounds.reserve(_vals.size());
+				for (const auto& val : _vals)
+				{
+					if (val.to < val.from || !impl::rnd_bounded<63>::valid(impl::rnd_length(val.from, val.to))) break;
+					bounds.emplace_back(impl::rnd_length(val.from, val.to));
+				}
+				if (bounds.size() == _vals.size())
+				{
+					impl::rnd_bits_stream<63> bits;
+					impl::rnd_bounded<63> bounded(_vals.size());
+					for (; first != last; ++first)
+					{
+						size_t i = size_t(bounded(bits));
+						*first = impl::rnd_offset(_vals[i].from, bounds[i](bits));
+					}
+					return;
+				}
+			}
+
+			if (_opts.random_mode == range_random_mode::uniform_by_length)
+			{
+				constexpr int bitCount = std::is_same_v<value_type, int> || std::is_same_v<value_type, unsigned int> ? 31 : 63;
+				_ensure_index();
+				if (_total > value_type(0) && impl::rnd_bounded<bitCount>::valid(static_cast<unsigned long long>(_total)))
+				{
+					impl::rnd_bits_stream<bitCount> bits;
+					impl::rnd_bounded<bitCount>(static_cast<unsigned long long>(_total)).fill(bits, first, last,
+						[this](unsigned long long offset) { return _value_by_offset(value_type(offset)); });
+					return;
+				}
+			}
+		}
+		for (; first != last; ++first) *first = get_rnd();
+	}
+
+	template <typename T>
+	T range_array<T>::_draw_offset(value_type length) const
+	{
+		// offsets in [0; length) for integers and [0; length) for floating values
+		double parameter = _opts.distribution_parameter;
+		switch (_opts.distribution)
+		{
+		case range_distribution::uniform:
+			return rnd.next(length);
+		case range_distribution::skewed:
+		{
+			ensuref(parameter == std::floor(parameter) && std::abs(parameter) <= INT_MAX, "Skew type must be an integer.");
+			if (parameter == 0) return rnd.next(length);
+			// inverse of x^(type + 1), the distribution function of the maximum of type + 1 uniform values
+			double value = std::pow(rnd.next(), 1 / (std::abs(parameter) + 1));
+			if (parameter < 0) value = 1 - value;
+			if constexpr (std::is_integral_v<value_type>)
+			{
+				return std::min(value_type(value * double(length)), value_type(length - 1));
+			}
+			else return value * length;
+		}
+		case range_distribution::zipf:
+		case range_distribution::geometric:
+			if constexpr (std::is_integral_v<value_type>)
+			{
+				ensuref(length > value_type(0), "Can not get rnd for empty range.");
+				double n = double(length);
+				double offset;
+				if (_opts.distribution == range_distribution::geometric)
+				{
+					ensuref(parameter > 0 && parameter <= 1, "Geometric distribution parameter must be in (0, 1].");
+					if (parameter == 1) return value_type(0);
+					// inverse of the distribution function truncated to [0; length)
+					double logQ = std::log1p(-parameter);
+					offset = std::floor(std::log1p(rnd.next() * std::expm1(n * logQ)) / logQ);
+				}
+				else
+				{
+					ensuref(parameter > 0, "Zipf exponent must be positive.");
+					offset = double(impl::zipf_rejection_inversion(parameter, n)) - 1;
+				}
+				return std::min(value_type(std::max(offset, 0.0)), value_type(length - 1));
+			}
+			else
+			{
+				ensuref(false, "Zipf and geometric distributions are defined only for integers.");
+				throw;
+			}
+		default:
+			ensuref(false, "Invalid range distribution.");
+			throw;
+		}
+	}
+
+	template <typename T>
+	size_t range_array<T>::_draw_range_index() const
+	{
+		switch (_opts.random_mode)
+		{
+		case range_random_mode::uniform_by_count:
+			return rnd.next(_vals.size());
+		case range_random_mode::weighted:
+		{
+			_ensure_alias();
+			size_t i = rnd.next(_vals.size());
+			return rnd.next() < _alias_prob[i] ? i : _alias[i];
+		}
+		default:
+			ensuref(false, "Invalid range-random mode.");
+			throw;
+		}
+	}
+
+	template <typename T>
+	T range_array<T>::_get_rnd_distributed() const
+	{
+		if (_opts.random_mode == range_random_mode::uniform_by_length)
+		{
+			_ensure_index();
+			return _value_by_offset(_draw_offset(_total));
+		}
+		const auto& val = _vals[_draw_range_index()];
+		return val.from + _draw_offset(val.length());
+	}
+
+	template <typename T>
+	T range_array<T>::_get_rnd_distributed_in_range(value_type minVal, value_type maxVal) const
+	{
+		// the same distribution as get_rnd() of the array of the ranges clipped by [minVal, maxVal]
+		_ensure_index();
+		if (!_ordered)
+		{
+			// the clipped array is kept for the next draws with the same bounds
+			if (!_clipped || _clipped_lower != minVal || _clipped_upper != maxVal)
+			{
+				auto clipped = std::make_shared<range_array>(_opts);
+				for (size_t i = 0; i < _vals.size(); ++i)
+				{
+					value_type from = std::max(minVal, _vals[i].from);
+					value_type to = std::min(maxVal, _vals[i].to);
+					if (from <= to) clipped->push_back(make_range(from, to), weight(i));
+				}
+				_clipped = std::move(clipped);
+				_clipped_lower = minVal;
+				_clipped_upper = maxVal;
+			}
+			if (_clipped->_vals.empty()) return _get_rnd_in_empty_range(minVal, maxVal);
+			return _clipped->get_rnd();
+		}
+
+		// ordered ranges: the clipped ranges are [first; last) with the first and the last cut by the bounds
+		size_t first = size_t(std::partition_point(_vals.begin(), _vals.end(),
+			[&](const range_type& val) { return val.to < minVal; }) - _vals.begin());
+		size_t last = size_t(std::partition_point(_vals.begin() + first, _vals.end(),
+			[&](const range_type& val) { return val.from <= maxVal; }) - _vals.begin());
+		if (maxVal < minVal || first == last) return _get_rnd_in_empty_range(minVal, maxVal);
+
+		if (_opts.random_mode == range_random_mode::uniform_by_length)
+		{
+			value_type skipped = minVal > _vals[first].from ? value_type(minVal - _vals[first].from) : value_type(0);
+			value_type end = last < _vals.size() ? _starts[last] : _total;
+			if (maxVal < _vals[last - 1].to) end -= _vals[last - 1].to - maxVal;
+			value_type offset = _starts[first] + skipped;
+			return _value_by_offset(offset + _draw_offset(value_type(end - offset)));
+		}
+
+		size_t i;
+		if (_opts.random_mode == range_random_mode::weighted)
+		{
+			_ensure_alias();
+			double low = _weight_sums[first], high = _weight_sums[last];
+			ensuref(high > low, "Sum of range weights must be positive.");
+			// the first range with a positive weight whose prefix sum covers the drawn point
+			double point = low + rnd.next() * (high - low);
+			i = size_t(std::upper_bound(_weight_sums.begin() + first + 1, _weight_sums.begin() + last, point) - _weight_sums.begin()) - 1;
+		}
+		else
+		{
+			ensuref(_opts.random_mode == range_random_mode::uniform_by_count, "Invalid range-random mode.");
+			i = first + rnd.next(last - first);
+		}
+		auto val = make_range(std::max(minVal, _vals[i].from), std::min(maxVal, _vals[i].to));
+		if (_opts.distribution == range_distribution::uniform) return val.get_rnd();
+		return val.from + _draw_offset(val.length());
+	}
+
+	template <typename T>
+	T range_array<T>::_get_rnd_uniform_by_count() const
+	{
+		return _vals[rnd.next(_vals.size())].get_rnd();
+	}
+
+	template <typename T>
+	T range_array<T>::_get_rnd_in_range_uniform_by_count(value_type minVal, value_type maxVal) const
+	{
+		return _vals[rnd.next(_vals.size())].get_rnd(minVal, maxVal);
+	}
+
+	template <typename T>
+	T range_array<T>::_get_rnd_uniform_by_values() const
+	{
+		_ensure_index();
+		return _value_by_offset(rnd.next(_total));
+	}
+
+	template <typename T>
+	T range_array<T>::_get_rnd_in_range_uniform_by_values(value_type minVal, value_type maxVal) const
+	{
+		_ensure_index();
+
+		// draws a value uniformly from the concatenation of ranges clipped by [minVal, maxVal]
+		if constexpr (std::is_integral_v<value_type>)
+		{
+			if (_ordered)
+			{
+				// reversed bounds would make the clipped length negative
+				if (maxVal < minVal) return _get_rnd_in_empty_range(minVal, maxVal);
+				size_t first = size_t(std::partition_point(_vals.begin(), _vals.end(),
+					[&](const range_type& val) { return val.to < minVal; }) - _vals.begin());
+				size_t last = size_t(std::partition_point(_vals.begin() + first, _vals.end(),
+					[&](const range_type& val) { return val.from <= maxVal; }) - _vals.begin());
+				if (first == last) return _get_rnd_in_empty_range(minVal, maxVal);
+
+				value_type skipped = minVal > _vals[first].from ? value_type(minVal - _vals[first].from) : value_type(0);
+				value_type end = last < _vals.size() ? _starts[last] : _total;
+				if (maxVal < _vals[last - 1].to) end -= _vals[last - 1].to - maxVal;
+
+				value_type offset = _starts[first] + skipped;
+				offset += rnd.next(value_type(end - offset));
+				size_t i = _find_by_offset(offset);
+				return _vals[i].from + (offset - _starts[i]);
+			}
+		}
+
+		// unordered or floating ranges: the same arithmetic as sampling from an array of the clipped ranges
+		value_type length = value_type(0);
+		bool found = false;
+		for (const auto& current : _vals)
+		{
+			value_type from = std::max(minVal, current.from);
+			value_type to = std::min(maxVal, current.to);
+			if (to < from) continue;
+			length += make_range(from, to).length();
+			found = true;
+		}
+		if (!found) return _get_rnd_in_empty_range(minVal, maxVal);
+
+		value_type index = rnd.next(length);
+		value_type firstFrom = value_type(0);
+		for (auto i = ptrdiff_t(_vals.size()) - 1; i >= 0; --i)
+		{
+			value_type from = std::max(minVal, _vals[i].from);
+			value_type to = std::min(maxVal, _vals[i].to);
+			if (to < from) continue;
+			length -= make_range(from, to).length();
+			if (index >= length) return from + (index - length);
+			firstFrom = from;
+		}
+		return firstFrom;
+	}
+
+	template <typename T>
+	T range_array<T>::_get_rnd_in_empty_range(value_type minVal, value_type maxVal) const
+	{
+		value_type value = _vals[0].from < minVal ? minVal : maxVal;
+		return rnd.next(value, value);
+	}
+
+#endif
+
+#pragma endregion
+
+	// set of integers stored as sorted, disjoint and non-adjacent ranges.
+	// set operations are linear in the number of ranges, lookups are logarithmic.
+	template<typename T>
+	class range_set
+	{
+		static_assert(std::is_integral_v<T>, "range_set supports only integral values");
+
+	public:
+		using value_type = T;
+		using range_type = range<value_type>;
+		using const_iterator = typename std::vector<range_type>::const_iterator;
+
+		range_set() = default;
+
+		range_set(const range_type& value) : range_set(&value, &value + 1) {}
+
+		explicit range_set(const range_array<value_type>& values)
+		{
+			std::vector<range_type> ranges;
+			ranges.reserve(values.size());
+			for (size_t i = 0; i < values.size(); ++i) ranges.push_back(values[i]);
+			_assign_unordered(std::move(ranges));
+		}
+
+		template<typename TIt>
+		range_set(TIt first, TIt last) { _assign_unordered(std::vector<range_type>(first, last)); }
+
+		// number of ranges
+		size_t size() const { return _vals.size(); }
+		bool empty() const { return _vals.empty(); }
+
+		const range_type& operator[](size_t index) const { return _vals[index]; }
+		const_iterator begin() const { return _vals.begin(); }
+		const_iterator end() const { return _vals.end(); }
+
+		// number of values in the set
+		value_type total_length() const { return _vals.empty() ? value_type(0) : value_type(_starts.back() + _vals.back().length()); }
+
+		bool contains(value_type value) const
+		{
+			size_t i = _find(value);
+			return i < _vals.size() && _vals[i].from <= value;
+		}
+
+		// returns number of values in the set less than value
+		value_type count_less(value_type value) const
+		{
+			size_t i = _find(value);
+			if (i == _vals.size()) return total_length();
+			return _vals[i].from < value ? value_type(_starts[i] + (value - _vals[i].from)) : _starts[i];
+		}
+
+		// returns value of the set with index smaller values, index must be less than total_length()
+		value_type nth(value_type index) const
+		{
+			size_t i = size_t(std::upper_bound(_starts.begin(), _starts.end(), index) - _starts.begin() - 1);
+			return _vals[i].from + (index - _starts[i]);
+		}
+
+		// returns values of [lowerBound, upperBound] not in the set
+		range_set complement(value_type lowerBound, value_type upperBound) const
+		{
+			std::vector<range_type> result;
+			value_type from = lowerBound;
+			bool tail = lowerBound <= upperBound;
+			for (const auto& val : _vals)
+			{
+				if (!tail || val.to < from) continue;
+				if (val.from > upperBound) break;
+				if (from < val.from) result.push_back(make_range(from, value_type(val.from - 1)));
+				if (val.to >= upperBound) tail = false;
+				else from = val.to + 1;
+			}
+			if (tail) result.push_back(make_range(from, upperBound));
+			return _from_ordered(std::move(result));
+		}
+
+		friend range_set operator|(const range_set& a, const range_set& b)
+		{
+			std::vector<range_type> result;
+			result.reserve(a.size() + b.size());
+			size_t i = 0, j = 0;
+			while (i < a.size() || j < b.size())
+			{
+				const range_type& next = j == b.size() || (i < a.size() && a[i].from < b[j].from) ? a[i++] : b[j++];
+				_append_merged(result, next);
+			}
+			return _from_ordered(std::move(result));
+		}
+
+		friend range_set operator&(const range_set& a, const range_set& b)
+		{
+			std::vector<range_type> result;
+			size_t i = 0, j = 0;
+			while (i < a.size() && j < b.size())
+			{
+				value_type from = std::max(a[i].from, b[j].from);
+				value_type to = std::min(a[i].to, b[j].to);
+				if (from <= to) result.push_back(make_range(from, to));
+				if (a[i].to < b[j].to) ++i;
+				else ++j;
+			}
+			return _from_ordered(std::move(result));
+		}
+
+		friend range_set operator-(const range_set& a, const range_set& b)
+		{
+			std::vector<range_type> result;
+			size_t j = 0;
+			for (const auto& val : a._vals)
+			{
+				value_type from = val.from;
+				bool rest = true;
+				while (j < b.size() && b[j].to < from) ++j;
+				for (size_t k = j; k < b.size() && b[k].from <= val.to; ++k)
+				{
+					if (from < b[k].from) result.push_back(make_range(from, value_type(b[k].from - 1)));
+					if (b[k].to >= val.to)
+					{
+						rest = false;
+						break;
+					}
+					from = b[k].to + 1;
+				}
+				if (rest) result.push_back(make_range(from, val.to));
+			}
+			return _from_ordered(std::move(result));
+		}
+
+		range_set& operator|=(const range_set& other) { return *this = *this | other; }
+		range_set& operator&=(const range_set& other) { return *this = *this & other; }
+		range_set& operator-=(const range_set& other) { return *this = *this - other; }
+
+		friend bool operator==(const range_set& a, const range_set& b)
+		{
+			return a.size() == b.size() && std::equal(a.begin(), a.end(), b.begin(),
+				[](const range_type& x, const range_type& y) { return x.from == y.from && x.to == y.to; });
+		}
+
+		friend bool operator!=(const range_set& a, const range_set& b) { return !(a == b); }
+
+		// ranges of the set in ascending order; such arrays are sampled in logarithmic time
+		range_array<value_type> to_range_array(const range_array_opts& opts = range_array_opts()) const
+		{
+			range_array<value_type> result(opts);
+			for (const auto& val : _vals) result.push_back(val);
+			return result;
+		}
+
+#ifdef _TESTLIB_H_
+		// returns random value of the set, all values are equally likely.
+		// draws the same values as to_range_array().get_rnd().
+		value_type get_rnd() const
+		{
+			ensuref(!_vals.empty(), "Can not get rnd for empty range set.");
+			if (_vals.size() == 1) return _vals[0].get_rnd();
+			return nth(rnd.next(total_length()));
+		}
+
+		// returns n distinct random values of the set, all subsets of size n are equally likely.
+		// values are sorted if sorted is set and randomly shuffled otherwise.
+		// uses Floyd's algorithm: O(n) expected draws and memory regardless of the set size.
+		std::vector<value_type> sample_distinct(size_t n, bool sorted = true) const
+		{
+			ensuref(total_length() >= value_type(0) && static_cast<unsigned long long>(total_length()) < static_cast<unsigned long long>(LLONG_MAX),
+				"Range set is too large to sample distinct values.");
+			long long count = static_cast<long long>(total_length());
+			ensuref(static_cast<unsigned long long>(n) <= static_cast<unsigned long long>(count),
+				"Can not sample %zu distinct values from %lld values.", n, count);
+
+			// draws do not depend on the picked values, so they are made first
+			// and the lookups, mostly cache misses, run in a separate tight loop
+			std::vector<long long> offsets(n);
+			long long first = count - static_cast<long long>(n);
+			for (size_t k = 0; k < n; ++k) offsets[k] = rnd.next(first + static_cast<long long>(k) + 1);
+			impl::offset_set picked(n);
+			for (size_t k = 0; k < n; ++k)
+			{
+				if (!picked.insert(offsets[k]))
+				{
+					offsets[k] = first + static_cast<long long>(k);
+					picked.insert(offsets[k]);
+				}
+			}
+
+			std::vector<value_type> result(n);
+			if (sorted)
+			{
+				// offsets in ascending order are mapped by a single pass over the ranges
+				impl::sort_uniform(offsets, count);
+				size_t i = 0;
+				for (size_t k = 0; k < n; ++k)
+				{
+					while (i + 1 < _vals.size() && static_cast<long long>(_starts[i + 1]) <= offsets[k]) ++i;
+					result[k] = _vals[i].from + value_type(offsets[k] - static_cast<long long>(_starts[i]));
+				}
+			}
+			else
+			{
+				shuffle(offsets.begin(), offsets.end());
+				for (size_t k = 0; k < n; ++k)
+				{
+					size_t i = size_t(std::upper_bound(_starts.begin(), _starts.end(), value_type(offsets[k])) - _starts.begin() - 1);
+					result[k] = _vals[i].from + value_type(offsets[k] - static_cast<long long>(_starts[i]));
+				}
+			}
+			return result;
+		}
+#endif
+
+	private:
+		std::vector<range_type> _vals;
+		// _starts[i] is the number of values in ranges before _vals[i]
+		std::vector<value_type> _starts;
+
+		// returns index of the first range which ends at value or later
+		size_t _find(value_type value) const
+		{
+			return size_t(std::partition_point(_vals.begin(), _vals.end(),
+				[&](const range_type& val) { return val.to < value; }) - _vals.begin());
+		}
+
+		// appends range which starts not before the last one, merging overlapping and adjacent ranges
+		static void _append_merged(std::vector<range_type>& ranges, const range_type& value)
+		{
+			if (value.to < value.from) return;
+			if (!ranges.empty() && (value.from <= ranges.back().to || value.from - 1 == ranges.back().to))
+			{
+				ranges.back().to = std::max(ranges.back().to, value.to);
+			}
+			else
+			{
+				ranges.push_back(value);
+			}
+		}
+
+		void _assign_unordered(std::vector<range_type> ranges)
+		{
+			std::sort(ranges.begin(), ranges.end(),
+				[](const range_type& a, const range_type& b) { return a.from < b.from; });
+			std::vector<range_type> merged;
+			for (const auto& val : ranges) _append_merged(merged, val);
+			*this = _from_ordered(std::move(merged));
+		}
+
+		static range_set _from_ordered(std::vector<range_type>&& ranges)
+		{
+			range_set result;
+			result._vals = std::move(ranges);
+			result._starts.resize(result._vals.size());
+			value_type count = value_type(0);
+			for (size_t i = 0; i < result._vals.size(); ++i)
+			{
+				result._starts[i] = count;
+				count += result._vals[i].length();
+			}
+			return result;
+		}
+	};
+
+#ifdef _TESTLIB_H_
+	template<typename T>
+	template<typename U, typename>
+	std::vector<T> range_array<T>::sample_distinct(size_t n, bool sorted) const
+	{
+		return range_set<value_type>(*this).sample_distinct(n, sorted);
+	}
+#endif
+
+	namespace impl
+	{
+		// treap of distinct keys with subtree sizes: insertion, rank and selection in O(log n) expected.
+		// priorities are hashes of the insertion order, so the tree does not draw from rnd.
+		template<typename T>
+		class rank_tree
+		{
+		public:
+			size_t size() const { return _nodes.size(); }
 
-	// struct for integer range [from; to] and for floating range [from; to) 
+			bool contains(T key) const
+			{
+				size_t t = _root;
+				while (t != none && _nodes[t].key != key) t = key < _nodes[t].key ? _nodes[t].left : _nodes[t].right;
+				return t != none;
+			}
+
+			// returns number of keys less than key
+			size_t count_less(T key) const
+			{
+				size_t count = 0;
+				for (size_t t = _root; t != none; )
+				{
+					if (_nodes[t].key < key)
+					{
+						count += _size(_nodes[t].left) + 1;
+						t = _nodes[t].right;
+					}
+					else t = _nodes[t].left;
+				}
+				return count;
+			}
+
+			// returns false if key is already in the tree
+			bool insert(T key)
+			{
+				if (contains(key)) return false;
+				unsigned long long priority = _nodes.size() + 0x9E3779B97F4A7C15ull;
+				priority = (priority ^ (priority >> 30)) * 0xBF58476D1CE4E5B9ull;
+				priority = (priority ^ (priority >> 27)) * 0x94D049BB133111EBull;
+				_nodes.push_back({ key, priority ^ (priority >> 31), none, none, 1 });
+				size_t left, right;
+				_split(_root, key, left, right);
+				_root = _merge(_merge(left, _nodes.size() - 1), right);
+				return true;
+			}
+
+			// returns the index-th non-negative integer which is not a key, keys must be non-negative
+			T nth_missing(T index) const
+			{
+				// a key precedes the answer if less than index + 1 missing integers are below it
+				size_t before = 0;
+				for (size_t t = _root; t != none; )
+				{
+					size_t rank = before + _size(_nodes[t].left);
+					if (_nodes[t].key - T(rank) <= index)
+					{
+						before = rank + 1;
+						t = _nodes[t].right;
+					}
+					else t = _nodes[t].left;
+				}
+				return index + T(before);
+			}
+
+		private:
+			static constexpr size_t none = ~size_t(0);
+
+			struct node
+			{
+				T key;
+				unsigned long long priority;
+				size_t left;
+				size_t right;
+				size_t size;
+			};
+
+			std::vector<node> _nodes;
+			size_t _root = none;
+
+			size_t _size(size_t t) const { return t == none ? 0 : _nodes[t].size; }
+
+			void _update(size_t t) { _nodes[t].size = _size(_nodes[t].left) + _size(_nodes[t].right) + 1; }
+
+			// splits tree t into keys less than key and the rest
+			void _split(size_t t, T key, size_t& left, size_t& right)
+			{
+				if (t == none)
+				{
+					left = right = none;
+					return;
+				}
+				if (_nodes[t].key < key)
+				{
+					_split(_nodes[t].right, key, _nodes[t].right, right);
+					left = t;
+				}
+				else
+				{
+					_split(_nodes[t].left, key, left, _nodes[t].left);
+					right = t;
+				}
+				_update(t);
+			}
+
+			// merges trees, keys of left are less than keys of right
+			size_t _merge(size_t left, size_t right)
+			{
+				if (left == none) return right;
+				if (right == none) return left;
+				if (_nodes[left].priority > _nodes[right].priority)
+				{
+					_nodes[left].right = _merge(_nodes[left].right, right);
+					_update(left);
+					return left;
+				}
+				_nodes[right].left = _merge(left, _nodes[right].left);
+				_update(right);
+				return right;
+			}
+		};
+	}
+
+	// set of integers with excluded values, for example ids of [1, 1e18] which are not used yet.
+	// excluded values are kept as their indices in the set of all values, so sampling is exact and uniform
+	// however many values are excluded, without rejection loops.
+	// exclusion, lookups and draws are O(log n) in the number of excluded values.
 	template<typename T>
-	struct range
+	class range_domain
 	{
+	public:
 		using value_type = T;
-		value_type from;
-		value_type to;
+		using range_type = range<value_type>;
 
-		range() = default;
-		range(value_type fromto) : from(fromto), to(fromto) {}
-		range(value_type from, value_type to) : from(from), to(to) {}
+		explicit range_domain(const range_type& values) : _values(values) {}
+		explicit range_domain(const range_set<value_type>& values) : _values(values) {}
+		explicit range_domain(const range_array<value_type>& values) : _values(values) {}
 
-		value_type length() const;
+		// all values of the domain including excluded ones
+		const range_set<value_type>& values() const { return _values; }
+
+		// number of remaining values
+		value_type total_length() const { return _values.total_length() - value_type(_excluded.size()); }
+		bool empty() const { return total_length() == value_type(0); }
+		size_t excluded_count() const { return _excluded.size(); }
+
+		bool contains(value_type value) const
+		{
+			return _values.contains(value) && !_excluded.contains(_values.count_less(value));
+		}
+
+		// returns false if value is not in the domain or is already excluded
+		bool exclude(value_type value)
+		{
+			return _values.contains(value) && _excluded.insert(_values.count_less(value));
+		}
+
+		// returns number of remaining values less than value
+		value_type count_less(value_type value) const
+		{
+			value_type index = _values.count_less(value);
+			return index - value_type(_excluded.count_less(index));
+		}
+
+		// returns remaining value with index smaller remaining values, index must be less than total_length()
+		value_type nth(value_type index) const { return _values.nth(_excluded.nth_missing(index)); }
 
 #ifdef _TESTLIB_H_
-		// returns random value in [form; to].
-		// for floating range: [from; to)
-		value_type get_rnd() const { return rnd.next(from, to); }
+		// returns random remaining value, all of them are equally likely
+		value_type get_rnd() const
+		{
+			ensuref(!empty(), "Can not get rnd for empty range domain.");
+			return nth(rnd.next(total_length()));
+		}
 
-		// returns random value in intersection of [form; to] and [lowerBound; upperBound].
-		// for floating range: [form; to) and [lowerBound; upperBound)
-		value_type get_rnd(value_type lowerBound, value_type upperBound) const
+		// returns random remaining value and excludes it
+		value_type take()
 		{
-			assert(lowerBound <= upperBound);
-			return rnd.next(
-				bound_value(lowerBound, upperBound, from),
-				bound_value(lowerBound, upperBound, to)
-			);
+			ensuref(!empty(), "Can not get rnd for empty range domain.");
+			value_type index = _excluded.nth_missing(rnd.next(total_length()));
+			_excluded.insert(index);
+			return _values.nth(index);
 		}
 #endif
+
+	private:
+		range_set<value_type> _values;
+		impl::rank_tree<value_type> _excluded;
 	};
 
-	template<typename T> T range<T>::length() const { return to - from + 1; }
-	template<> double range<double>::length() const { return to - from; }
-	template<> float range<float>::length() const { return to - from; }
+#pragma endregion
 
-	template<typename T>
-	range<T> make_range(T from, T to)
+#ifdef _TESTLIB_H_
+#pragma region tree generators
+
+	namespace gen
 	{
-		return range<T>(from, to);
+		// tree on vertices [0; n) kept as the parent of every vertex, 8 bytes per vertex and no adjacency lists,
+		// so trees of 10^7 vertices are generated and written in linear time.
+		// generators build a tree rooted at 0 and by default shuffle it: vertices are relabeled by a random permutation,
+		// edges are put in random order and random edges are flipped.
+		class tree
+		{
+		public:
+			// uniformly random labeled tree, a random Prufer code decoded in linear time
+			static tree prufer(int n, bool shuffled = true)
+			{
+				tree result(n);
+				if (n > 2)
+				{
+					std::vector<int> code(n - 2);
+					make_range(0, n - 1).fill_rnd(code.begin(), code.end());
+
+					// the code is decoded with root n - 1, which is stored as n - 1 - v to become 0
+					auto& degree = result._vertex;
+					std::fill(degree.begin(), degree.end(), 1);
+					for (int x : code) ++degree[x];
+					int ptr = 0;
+					while (degree[ptr] != 1) ++ptr;
+					int leaf = ptr;
+					for (int x : code)
+					{
+						result._parent[n - 1 - leaf] = n - 1 - x;
+						if (--degree[x] == 1 && x < ptr) leaf = x;
+						else
+						{
+							while (degree[++ptr] != 1);
+							leaf = ptr;
+						}
+					}
+					result._parent[n - 1 - leaf] = 0;
+					std::iota(degree.begin(), degree.end(), 0);
+				}
+				else if (n == 2) result._parent[1] = 0;
+				result._finish(shuffled);
+				return result;
+			}
+
+			// vertex v is attached to rnd.wnext(v, bias) of the previous ones:
+			// the tree is deeper for positive bias and shallower for negative, 0 gives a random recursive tree
+			static tree random_parent(int n, int bias = 0, bool shuffled = true)
+			{
+				tree result(n);
+				for (int v = 1; v < n; ++v) result._parent[v] = rnd.wnext(v, bias);
+				result._finish(shuffled);
+				return result;
+			}
+
+			static tree bamboo(int n, bool shuffled = true)
+			{
+				tree result(n);
+				for (int v = 1; v < n; ++v) result._parent[v] = v - 1;
+				result._finish(shuffled);
+				return result;
+			}
+
+			static tree star(int n, bool shuffled = true)
+			{
+				tree result(n);
+				std::fill(result._parent.begin() + 1, result._parent.end(), 0);
+				result._finish(shuffled);
+				return result;
+			}
+
+			// path of spine vertices, the other vertices are attached to random vertices of the path
+			static tree caterpillar(int n, int spine, bool shuffled = true)
+			{
+				ensuref(spine >= 1 && spine <= n, "Caterpillar spine must be in [1, n].");
+				tree result(n);
+				for (int v = 1; v < spine; ++v) result._parent[v] = v - 1;
+				make_range(0, spine - 1).fill_rnd(result._parent.begin() + spine, result._parent.end());
+				result._finish(shuffled);
+				return result;
+			}
+
+			// path of handle vertices, the other vertices are attached to its last vertex
+			static tree broom(int n, int handle, bool shuffled = true)
+			{
+				ensuref(handle >= 1 && handle <= n, "Broom handle must be in [1, n].");
+				tree result(n);
+				for (int v = 1; v < handle; ++v) result._parent[v] = v - 1;
+				std::fill(result._parent.begin() + handle, result._parent.end(), handle - 1);
+				result._finish(shuffled);
+				return result;
+			}
+
+			int vertex_count() const { return int(_vertex.size()); }
+			size_t edge_count() const { return _vertex.size() - 1; }
+
+			// root of the generated tree, edges of a not shuffled tree are directed to it
+			int root() const { return _vertex[0]; }
+
+			std::pair<int, int> edge(size_t index) const { return { _vertex[index + 1], _parent[index + 1] }; }
+
+			// writes edge_count() lines "u v", vertices are numbered from base
+			void write(io::writer& out, int base = 1) const
+			{
+				for (size_t i = 1; i < _vertex.size(); ++i)
+				{
+					out.write_number(_vertex[i] + base).write(' ').write_number(_parent[i] + base).write('\n');
+				}
+			}
+
+		private:
+			// entry 0 is the root, entry i > 0 is edge (_vertex[i], _parent[i])
+			std::vector<int> _vertex;
+			std::vector<int> _parent;
+
+			explicit tree(int n)
+			{
+				ensuref(n >= 1, "Tree must have at least one vertex.");
+				_vertex.resize(n);
+				std::iota(_vertex.begin(), _vertex.end(), 0);
+				_parent.assign(n, -1);
+			}
+
+			void _finish(bool shuffled)
+			{
+				if (shuffled) _shuffle();
+			}
+
+			// labels are still the entry indices here
+			void _shuffle()
+			{
+				int n = vertex_count();
+				for (int i = 1; i < n; ++i) std::swap(_vertex[i], _vertex[rnd.next(i + 1)]);
+				for (int i = 1; i < n; ++i) _parent[i] = _vertex[_parent[i]];
+
+				for (int i = n - 1; i > 1; --i)
+				{
+					int j = 1 + rnd.next(i);
+					std::swap(_vertex[i], _vertex[j]);
+					std::swap(_parent[i], _parent[j]);
+				}
+
+				// 30 flips per draw
+				for (int i = 1; i < n; i += 30)
+				{
+					int flips = rnd.next(1 << 30);
+					for (int j = i; j < std::min(n, i + 30); ++j, flips >>= 1)
+					{
+						if (flips & 1) std::swap(_vertex[j], _parent[j]);
+					}
+				}
+			}
+		};
 	}
 
-	enum class range_random_mode
-	{
-		uniform_by_length,
-		uniform_by_count,
-	};
+#pragma endregion
+#endif
 
-	struct range_array_opts
-	{
-		range_random_mode random_mode = range_random_mode::uniform_by_length;
-	};
+#ifdef _TESTLIB_H_
+#pragma region graph generators
 
-	template<typename T>
-	class range_array
+	namespace gen
 	{
-	public:
-		using value_type = T;
-		using range_type = range<value_type>;
+		struct graph_opts
+		{
+			bool directed = false;
+			// directed graph with edges going forward in a random order of vertices
+			bool acyclic = false;
+			// if positive, vertices [0; left) and [left; n) are the parts of a bipartite graph,
+			// edges go from the left part to the right one unless the graph is directed and not acyclic
+			int left = 0;
+			// the graph contains a random spanning tree, weakly connected for directed graphs
+			bool connected = true;
+		};
 
-		range_array() = default;
-		range_array(const range_type& range) : _vals(1, range) { }
-		explicit range_array(const range_array_opts& opts) : _opts(opts) {}
+		// random simple graph on vertices [0; n), kept as a list of edges, 8 bytes per edge.
+		// generation lays a random spanning tree and adds the other edges either by rejection
+		// with an open addressing hash set of edges, which becomes the list of edges, at most 3/4 full,
+		// or for dense graphs by enumerating all possible edges except a Floyd sample of the missing ones.
+		class graph
+		{
+		public:
+			// m random edges, all graphs with the options are possible.
+			// by default vertices are relabeled by a random permutation (within the parts of a bipartite graph),
+			// edges are put in random order and undirected edges are flipped randomly,
+			// otherwise edges are sorted and go from the smaller vertex in undirected and acyclic graphs.
+			static graph random(int n, long long m, const graph_opts& opts = graph_opts(), bool shuffled = true)
+			{
+				ensuref(n >= 1 && n < INT_MAX, "Graph must have at least one vertex.");
+				ensuref(opts.left >= 0 && (opts.left < n || n == 1), "Left part of bipartite graph must be in [1, n).");
+				graph result(n, opts);
+				long long space = result._pair_count();
+				ensuref(m >= 0 && m <= space, "Can not generate %lld edges, only %lld are possible.", m, space);
+				ensuref(!opts.connected || m >= n - 1, "Connected graph on %d vertices must have at least %d edges.", n, n - 1);
 
-		range_array_opts& options() { return _opts; }
-		const range_array_opts& options() const { return _opts; }
+				std::vector<long long> tree;
+				if (opts.connected) tree = result._spanning_tree();
+				long long extra = m - static_cast<long long>(tree.size());
+				long long free = space - static_cast<long long>(tree.size());
+				if (extra <= free / 2)
+				{
+					impl::offset_set edges(size_t(m), 0.75);
+					for (long long key : tree) edges.insert(key);
+					tree = std::vector<long long>();
+					for (long long added = 0; added < extra; )
+					{
+						if (edges.insert(result._rnd_pair())) ++added;
+					}
+					result._edges = edges.release();
+				}
+				else
+				{
+					std::sort(tree.begin(), tree.end());
+					auto missing = range_set<long long>(make_range(0LL, free - 1)).sample_distinct(size_t(free - extra));
+					result._edges.reserve(size_t(m));
+					auto nextTree = tree.begin();
+					auto nextMissing = missing.begin();
+					long long rank = 0;
+					result._for_each_pair([&](long long key)
+					{
+						if (nextTree != tree.end() && *nextTree == key)
+						{
+							result._edges.push_back(key);
+							++nextTree;
+						}
+						else if (nextMissing != missing.end() && *nextMissing == rank++) ++nextMissing;
+						else result._edges.push_back(key);
+					});
+				}
 
-		void push_back(const range_type& value) { _vals.push_back(value); }
-		size_t size() const { return _vals.size(); }
+				result._finish(shuffled);
+				return result;
+			}
 
-		value_type total_length() const
-		{
-			return std::accumulate(
-				_vals.begin(),
-				_vals.end(),
-				value_type(0),
-				[](value_type current, const range_type & val) { return current + val.length(); }
-			);
-		}
+			// undirected simple graph where vertex v has degree degrees[v], the sequence must be graphical.
+			// a graph is built by Havel-Hakimi and randomized by the given number of double edge swap steps,
+			// shuffling keeps the vertex labels, puts edges in random order and flips them randomly.
+			static graph with_degrees(const std::vector<int>& degrees, long long swaps, bool shuffled = true)
+			{
+				graph result = _havel_hakimi(degrees);
+				ensuref(2 * static_cast<long long>(result._edges.size()) == std::accumulate(degrees.begin(), degrees.end(), 0LL),
+					"Degree sequence is not graphical.");
+				result._swap_edges(swaps);
+				result._finish(shuffled, false);
+				return result;
+			}
 
-		const range_type& operator[](size_t index) const { return _vals[index]; }
-		range_type& operator[](size_t index) { return _vals[index]; }
+			// undirected simple graph on n vertices with degrees drawn by degrees.get_rnd(),
+			// e.g. a single value for regular graphs or a zipf distribution for power-law ones.
+			// degrees of a sequence which is not graphical are lowered: each vertex of the largest remaining degree
+			// is connected to as many vertices as remain.
+			static graph with_degrees(int n, const range_array<int>& degrees, long long swaps, bool shuffled = true)
+			{
+				ensuref(n >= 1 && n < INT_MAX, "Graph must have at least one vertex.");
+				graph result = _havel_hakimi(degrees.get_rnd_n(size_t(n)));
+				result._swap_edges(swaps);
+				result._finish(shuffled);
+				return result;
+			}
+
+			int vertex_count() const { return _n; }
+			size_t edge_count() const { return _edges.size(); }
+
+			std::pair<int, int> edge(size_t index) const { return { int(_edges[index] >> 32), int(_edges[index] & UINT_MAX) }; }
+
+			// writes edge_count() lines "u v", vertices are numbered from base
+			void write(io::writer& out, int base = 1) const
+			{
+				for (size_t i = 0; i < _edges.size(); ++i)
+				{
+					auto [u, v] = edge(i);
+					out.write_number(u + base).write(' ').write_number(v + base).write('\n');
+				}
+			}
+
+			// writes edge_count() lines "u v w", weights are drawn while writing, the same as weights.get_rnd() for every edge in order
+			template<typename T>
+			void write(io::writer& out, const range_array<T>& weights, int base = 1) const
+			{
+				constexpr size_t block = 1 << 12;
+				std::vector<T> drawn(std::min(block, _edges.size()));
+				for (size_t first = 0; first < _edges.size(); first += block)
+				{
+					size_t count = std::min(block, _edges.size() - first);
+					weights.fill_rnd(drawn.begin(), drawn.begin() + count);
+					for (size_t i = 0; i < count; ++i)
+					{
+						auto [u, v] = edge(first + i);
+						out.write_number(u + base).write(' ').write_number(v + base).write(' ') << drawn[i];
+						out.write('\n');
+					}
+				}
+			}
+
+		private:
+			int _n;
+			graph_opts _opts;
+			// u << 32 | v, so keys are ordered as pairs
+			std::vector<long long> _edges;
+
+			graph(int n, const graph_opts& opts) : _n(n), _opts(opts)
+			{
+				_opts.directed = opts.directed || opts.acyclic;
+			}
+
+			bool _both_ways() const { return _opts.directed && !_opts.acyclic; }
+
+			static long long _key(int u, int v) { return (static_cast<long long>(u) << 32) | v; }
+
+			long long _pair_count() const
+			{
+				long long pairs = _opts.left > 0
+					? static_cast<long long>(_opts.left) * (_n - _opts.left)
+					: static_cast<long long>(_n) * (_n - 1) / 2;
+				return _both_ways() ? pairs * 2 : pairs;
+			}
+
+			// calls f with the keys of all possible edges in ascending order
+			template<typename TFunc>
+			void _for_each_pair(TFunc f) const
+			{
+				int left = _opts.left;
+				for (int u = 0; u < _n; ++u)
+				{
+					if (left > 0)
+					{
+						int from = u < left ? left : 0;
+						int to = u < left ? _n : (_both_ways() ? left : 0);
+						for (int v = from; v < to; ++v) f(_key(u, v));
+					}
+					else
+					{
+						for (int v = _both_ways() ? 0 : u + 1; v < _n; ++v)
+						{
+							if (v != u) f(_key(u, v));
+						}
+					}
+				}
+			}
 
-		template<typename = std::enable_if_t < std::is_integral<value_type>{} >>
-			std::vector<value_type> get_all_values() const
-		{
-			auto result = std::vector<value_type>();
-			for (const auto& val : _vals)
+			// key of a random possible edge, all of them are equally likely
+			long long _rnd_pair() const
 			{
-				for (value_type current = val.from; current <= val.to; ++current)
+				int u, v;
+				if (_opts.left > 0)
 				{
-					result.push_back(current);
+					u = rnd.next(_opts.left);
+					v = _opts.left + rnd.next(_n - _opts.left);
+					if (_both_ways() && rnd.next(2)) std::swap(u, v);
+				}
+				else
+				{
+					u = rnd.next(_n);
+					v = rnd.next(_n - 1);
+					if (v >= u) ++v;
+					if (!_both_ways() && u > v) std::swap(u, v);
 				}
+				return _key(u, v);
 			}
-			return result;
-		}
-
-#ifdef _TESTLIB_H_
-		// returns random value in range array
-		value_type get_rnd() const;
 
-		// returns random value in array of intersections with [lowerBound, upperBound]
-		value_type get_rnd(value_type lowerBound, value_type upperBound) const;
-#endif
+			// keys of a random spanning tree: a uniform labeled tree, or for bipartite graphs
+			// vertices of both parts in random interleaving attached to random earlier vertices of the other part
+			std::vector<long long> _spanning_tree() const
+			{
+				std::vector<long long> keys;
+				keys.reserve(size_t(_n - 1));
+				auto add = [&](int u, int v)
+				{
+					if (_both_ways() ? rnd.next(2) != 0 : (_opts.left == 0 && u > v)) std::swap(u, v);
+					keys.push_back(_key(u, v));
+				};
 
-	private:
-		range_array_opts _opts;
-		std::vector<range_type> _vals;
+				if (_opts.left > 0)
+				{
+					int left = _opts.left;
+					int leftDone = 1, rightDone = 1;
+					if (_n > 1) add(0, left);
+					while (leftDone < left || left + rightDone < _n)
+					{
+						int leftRest = left - leftDone;
+						if (rnd.next(leftRest + (_n - left - rightDone)) < leftRest) add(leftDone++, left + rnd.next(rightDone));
+						else add(rnd.next(leftDone), left + rightDone++);
+					}
+				}
+				else
+				{
+					tree spanning = tree::prufer(_n, false);
+					for (size_t i = 0; i < spanning.edge_count(); ++i) add(spanning.edge(i).first, spanning.edge(i).second);
+				}
+				return keys;
+			}
 
-		value_type _get_rnd_uniform_by_values() const;
-		value_type _get_rnd_in_range_uniform_by_values(value_type minVal, value_type maxVal) const;
-		value_type _get_rnd_uniform_by_count() const;
-		value_type _get_rnd_in_range_uniform_by_count(value_type minVal, value_type maxVal) const;
-	};
+			void _finish(bool shuffled, bool relabeled = true)
+			{
+				if (shuffled) _shuffle(relabeled);
+				else std::sort(_edges.begin(), _edges.end());
+			}
 
+			// Havel-Hakimi: a vertex of the largest degree is connected to the vertices of the next largest degrees.
+			// vertices are kept sorted by remaining degree with the start of every degree bucket,
+			// a degree is decremented by a swap with the first vertex of its bucket, so the whole build is O(n + m).
+			static graph _havel_hakimi(const std::vector<int>& degrees)
+			{
+				int n = int(degrees.size());
+				ensuref(n >= 1 && n < INT_MAX, "Graph must have at least one vertex.");
+				std::vector<int> degree(n);
+				for (int v = 0; v < n; ++v)
+				{
+					ensuref(degrees[v] >= 0, "Degree must be non-negative.");
+					degree[v] = std::min(degrees[v], n - 1);
+				}
 
-#pragma region Rnd in range impl
+				std::vector<int> start(n + 1, 0);
+				for (int d : degree) ++start[d + 1];
+				std::partial_sum(start.begin(), start.end(), start.begin());
+				std::vector<int> order(n), position(n);
+				{
+					std::vector<int> next(start.begin(), start.end() - 1);
+					for (int v = 0; v < n; ++v) order[position[v] = next[degree[v]]++] = v;
+				}
 
-#ifdef _TESTLIB_H_
+				graph result(n, graph_opts());
+				std::vector<int> neighbors;
+				for (int size = n; size > 0 && degree[order[size - 1]] > 0; )
+				{
+					int v = order[--size];
+					// vertices of positive degree are [start[1]; size)
+					int count = std::min(degree[v], size - start[1]);
+					degree[v] = 0;
+					neighbors.assign(order.begin() + (size - count), order.begin() + size);
+					for (int u : neighbors)
+					{
+						int& first = start[degree[u]];
+						int w = order[first];
+						std::swap(order[first], order[position[u]]);
+						std::swap(position[w], position[u]);
+						++first;
+						--degree[u];
+						result._edges.push_back(_key(std::min(u, v), std::max(u, v)));
+					}
+				}
+				return result;
+			}
 
-	template<typename T>
-	T range_array<T>::get_rnd() const
-	{
-		ensuref(!_vals.empty(), "Can not get rnd for empty range array.");
-		if (_vals.size() == 1) return _vals[0].get_rnd();
-		switch (_opts.random_mode)
-		{
-		case range_random_mode::uniform_by_count:
-			return _get_rnd_uniform_by_count();
-		case range_random_mode::uniform_by_length:
-			return _get_rnd_uniform_by_values();
-		default:
-			ensuref(false, "Invalid range-random mode.");
-			throw;
-		}
-	}
+			struct _swap_step
+			{
+				size_t i, j;
+				bool flip;
+			};
 
-	template<typename T>
-	T range_array<T>::get_rnd(T lowerBound, T upperBound) const
-	{
-		ensuref(!_vals.empty(), "Can not get rnd for empty range array.");
-		if (_vals.size() == 1) return _vals[0].get_rnd(lowerBound, upperBound);
-		switch (_opts.random_mode)
-		{
-		case range_random_mode::uniform_by_count:
-			return _get_rnd_in_range_uniform_by_count(lowerBound, upperBound);
-		case range_random_mode::uniform_by_length:
-			return _get_rnd_in_range_uniform_by_values(lowerBound, upperBound);
-		default:
-			ensuref(false, "Invalid range-random mode.");
-			throw;
-		}
-	}
+			// double edge swaps: two random edges a-b and c-d become a-d and c-b or a-c and b-d,
+			// a step is skipped if it makes a loop or a multiple edge. degrees are kept.
+			void _swap_edges(long long steps)
+			{
+				ensuref(steps >= 0, "Number of swaps must be non-negative.");
+				if (_edges.size() < 2 || steps == 0) return;
+				impl::offset_set edges(_edges.size(), 0.75);
+				for (long long key : _edges) edges.insert(key);
 
-	template <typename T>
-	T range_array<T>::_get_rnd_uniform_by_count() const
-	{
-		return _vals[rnd.next(_vals.size())].get_rnd();
-	}
+				// draws do not depend on the outcome of steps, so they are made ahead in a ring:
+				// the edges of a step are prefetched when it is drawn and its hash slots half the ring later
+				constexpr long long ahead = 32;
+				_swap_step ring[ahead];
+				impl::rnd_bits_stream<63> bits;
+				impl::rnd_bounded<63> index(_edges.size()), coin(2);
+				auto draw = [&](long long step)
+				{
+					if (step >= steps) return;
+					auto& drawn = ring[step % ahead];
+					drawn.i = size_t(index(bits));
+					drawn.j = size_t(index(bits));
+					drawn.flip = coin(bits) != 0;
+					impl::prefetch(&_edges[drawn.i]);
+					impl::prefetch(&_edges[drawn.j]);
+				};
+				for (long long step = 0; step < ahead; ++step) draw(step);
 
-	template <typename T>
-	T range_array<T>::_get_rnd_in_range_uniform_by_count(value_type minVal, value_type maxVal) const
-	{
-		return _vals[rnd.next(_vals.size())].get_rnd(minVal, maxVal);
-	}
+				for (long long step = 0; step < steps; ++step)
+				{
+					long long first, second;
+					if (step + ahead / 2 < steps)
+					{
+						const auto& later = ring[(step + ahead / 2) % ahead];
+						edges.prefetch(_edges[later.i]);
+						edges.prefetch(_edges[later.j]);
+						if (_swapped(later, first, second))
+						{
+							edges.prefetch(first);
+							edges.prefetch(second);
+						}
+					}
 
-	template <typename T>
-	T range_array<T>::_get_rnd_uniform_by_values() const
-	{
-		value_type length = total_length();
-		value_type index = rnd.next(length);
+					const auto current = ring[step % ahead];
+					draw(step + ahead);
+					if (!_swapped(current, first, second) || edges.contains(first) || edges.contains(second)) continue;
+					edges.erase(_edges[current.i]);
+					edges.erase(_edges[current.j]);
+					edges.insert(_edges[current.i] = first);
+					edges.insert(_edges[current.j] = second);
+				}
+			}
 
-		for (auto i = ptrdiff_t(_vals.size()) - 1; i >= 0; --i)
-		{
-			length -= _vals[i].length();
-			if (index >= length)
+			// keys of the edges made by a swap step, false if it makes a loop
+			bool _swapped(const _swap_step& step, long long& first, long long& second) const
 			{
-				return _vals[i].from + (index - length);
+				auto [a, b] = edge(step.i);
+				auto [c, d] = edge(step.j);
+				if (step.flip) std::swap(c, d);
+				if (a == d || c == b) return false;
+				first = _key(std::min(a, d), std::max(a, d));
+				second = _key(std::min(c, b), std::max(c, b));
+				return true;
 			}
-		}
-		return _vals[0].from;
-	}
-
-	template <typename T>
-	T range_array<T>::_get_rnd_in_range_uniform_by_values(value_type minVal, value_type maxVal) const
-	{
-		range_array<value_type> narr(_opts);
-		for (size_t i = 0; i < _vals.size(); i++)
-		{
-			const range_type& current = _vals[i];
-			value_type from = std::max(minVal, current.from);
-			value_type to = std::min(maxVal, current.to);
-			if (to < from) continue;
-			narr.push_back(make_range(from, to));
-		}
-		if (narr.size() == 0)
-		{
-			value_type value = _vals[0].from < minVal ? minVal : maxVal;
-			return rnd.next(value, value);
-		}
-		return narr._get_rnd_uniform_by_values();
-	}
 
-#endif
+			void _shuffle(bool relabeled)
+			{
+				std::vector<int> label(_n);
+				std::iota(label.begin(), label.end(), 0);
+				if (relabeled)
+				{
+					int left = _opts.left > 0 ? _opts.left : _n;
+					shuffle(label.begin(), label.begin() + left);
+					shuffle(label.begin() + left, label.end());
+				}
 
-#pragma endregion
+				bool flip = !_opts.directed && _opts.left == 0;
+				for (size_t i = 0; i < _edges.size(); i += 30)
+				{
+					int flips = flip ? rnd.next(1 << 30) : 0;
+					for (size_t j = i; j < std::min(_edges.size(), i + 30); ++j, flips >>= 1)
+					{
+						auto [u, v] = edge(j);
+						_edges[j] = flips & 1 ? _key(label[v], label[u]) : _key(label[u], label[v]);
+					}
+				}
+				shuffle(_edges.begin(), _edges.end());
+			}
+		};
+	}
 
 #pragma endregion
+#endif
 
 	namespace arguments
 	{
@@ -469,19 +4161,88 @@ namespace problib
 		struct prefixes
 		{
 			std::string rnd_mode_uniform_by_count = "!";
+			// distribution prefixes take the parameter in parentheses, for example zipf(1.5)[1,1000]
+			std::string distribution_skewed = "skew";
+			std::string distribution_zipf = "zipf";
+			std::string distribution_geometric = "geom";
 		};
 
 		struct parsing_options
 		{
-			brackets brackets;
-			prefixes prefixes;
+			arguments::brackets brackets;
+			arguments::prefixes prefixes;
 			std::string items_separator = ",";
+			// separates weight of an item for range_random_mode::weighted, for example {[1,10]:3,[100,200]:1}
+			std::string weight_separator = ":";
+		};
+
+		// parsing options usable in constant expressions, with the same defaults as parsing_options
+		struct literal_parsing_options
+		{
+			std::string_view range_open_exclusive = "(";
+			std::string_view range_close_exclusive = ")";
+			std::string_view range_open_inclusive = "[";
+			std::string_view range_close_inclusive = "]";
+			std::string_view rangeset_open = "{";
+			std::string_view rangeset_close = "}";
+			std::string_view rnd_mode_uniform_by_count = "!";
+			std::string_view distribution_skewed = "skew";
+			std::string_view distribution_zipf = "zipf";
+			std::string_view distribution_geometric = "geom";
+			std::string_view items_separator = ",";
+			std::string_view weight_separator = ":";
+		};
+
+		// range array parsed by parse_range_literal, holds up to N items
+		template<typename T, size_t N>
+		class range_literal
+		{
+		public:
+			using value_type = T;
+			using range_type = range<value_type>;
+
+			constexpr range_literal() = default;
+			// src is the parsed text, it must outlive the literal
+			constexpr explicit range_literal(std::string_view src) : _src(src) {}
+
+			constexpr std::string_view src() const { return _src; }
+
+			constexpr range_array_opts& options() { return _opts; }
+			constexpr const range_array_opts& options() const { return _opts; }
+
+			constexpr void push_back(const range_type& value, double weight)
+			{
+				if (_size == N) throw std::length_error("range literal has too many items");
+				_vals[_size] = value;
+				_weights[_size] = weight;
+				++_size;
+			}
+
+			constexpr size_t size() const { return _size; }
+			constexpr const range_type& operator[](size_t index) const { return _vals[index]; }
+			constexpr double weight(size_t index) const { return _weights[index]; }
+
+			range_array<value_type> to_range_array() const
+			{
+				range_array<value_type> result(_opts);
+				for (size_t i = 0; i < _size; ++i) result.push_back(_vals[i], _weights[i]);
+				return result;
+			}
+
+			operator range_array<value_type>() const { return to_range_array(); }
+
+		private:
+			std::string_view _src;
+			range_array_opts _opts;
+			range_type _vals[N] = {};
+			double _weights[N] = {};
+			size_t _size = 0;
 		};
 
 		namespace impl_arg_parsing
 		{
 			template<typename T>
-			std::enable_if_t < std::is_integral<T>::value, T > normalize_range_bound(const T& value, int sign)
+			constexpr std::enable_if_t < std::is_integral<T>::value, T > normalize_range_bound(const T& value, int sign)
 			{
 				if (sign < 0) return value - 1;
 				if (sign > 0) return value + 1;
@@ -489,122 +4250,465 @@ namespace problib
 			}
 
 			template<typename T>
-			std::enable_if_t < !std::is_integral<T>::value, T > normalize_range_bound(const T& value, int sign)
+			constexpr std::enable_if_t < !std::is_integral<T>::value, T > normalize_range_bound(const T& value, int sign)
 			{
 				return value;
 			}
 
+			inline literal_parsing_options make_literal_options(const parsing_options& options)
+			{
+				literal_parsing_options result;
+				result.range_open_exclusive = options.brackets.range_open_exclusive;
+				result.range_close_exclusive = options.brackets.range_close_exclusive;
+				result.range_open_inclusive = options.brackets.range_open_inclusive;
+				result.range_close_inclusive = options.brackets.range_close_inclusive;
+				result.rangeset_open = options.brackets.rangeset_open;
+				result.rangeset_close = options.brackets.rangeset_close;
+				result.rnd_mode_uniform_by_count = options.prefixes.rnd_mode_uniform_by_count;
+				result.distribution_skewed = options.prefixes.distribution_skewed;
+				result.distribution_zipf = options.prefixes.distribution_zipf;
+				result.distribution_geometric = options.prefixes.distribution_geometric;
+				result.items_separator = options.items_separator;
+				result.weight_separator = options.weight_separator;
+				return result;
+			}
+
+			constexpr std::string_view trim_item(std::string_view s)
+			{
+				constexpr str::char_class spaces = str::char_class::space();
+				while (!s.empty() && spaces.contains(s.front())) s.remove_prefix(1);
+				while (!s.empty() && spaces.contains(s.back())) s.remove_suffix(1);
+				return s;
+			}
 
-			template<typename T>
-			std::pair<range<T>, bool> try_parse_range_from_parts(std::string_view left, std::string_view right, const brackets& brackets)
+			// numbers of runtime values
+			struct runtime_numbers
+			{
+				template<typename U>
+				U parse(std::string_view s) const { return str::parse<U>(s); }
+			};
+
+			// numbers of literals: integers are accepted as by str::parse, including the exponent form,
+			// floating values need at most 15 significant digits and a decimal exponent within 22,
+			// then they are rounded exactly as by str::parse.
+			struct literal_numbers
+			{
+				template<typename U>
+				constexpr U parse(std::string_view s) const
+				{
+					static_assert(std::is_arithmetic_v<U> && !std::is_same_v<U, bool>, "range literals support only numbers");
+					s = trim_item(s);
+					if (s.size() > 1 && s[0] == '+' && s[1] != '-') s.remove_prefix(1);
+					bool negative = !s.empty() && s[0] == '-';
+					if (negative) s.remove_prefix(1);
+
+					size_t e = s.find_first_of("eE");
+					std::string_view mantissa = s.substr(0, e);
+					long long exponent = 0;
+					if (e != std::string_view::npos)
+					{
+						std::string_view exponentPart = s.substr(e + 1);
+						if (!exponentPart.empty() && exponentPart[0] == '+') exponentPart.remove_prefix(1);
+						bool negativeExponent = !exponentPart.empty() && exponentPart[0] == '-';
+						if (negativeExponent) exponentPart.remove_prefix(1);
+						if (exponentPart.empty()) throw std::invalid_argument("parsing failed");
+						for (char c : exponentPart)
+						{
+							if (c < '0' || c > '9' || exponent > INT_MAX / 10) throw std::invalid_argument("parsing failed");
+							exponent = exponent * 10 + (c - '0');
+						}
+						if (negativeExponent) exponent = -exponent;
+					}
+					// integers take the decimal point only with an exponent
+					if constexpr (std::is_integral_v<U>)
+					{
+						if (e == std::string_view::npos && mantissa.find('.') != std::string_view::npos) throw std::invalid_argument("parsing failed");
+						if (negative && !std::is_signed_v<U>) throw std::invalid_argument("parsing failed");
+						// as str::parse, the whole mantissa of the exponent form must fit the type
+						const unsigned long long wholeLimit = static_cast<unsigned long long>(std::numeric_limits<U>::max()) + (negative && std::is_signed_v<U> ? 1 : 0);
+						unsigned long long whole = 0;
+						for (char c : mantissa)
+						{
+							if (c < '0' || c > '9') continue;
+							unsigned digit = unsigned(c - '0');
+							if (whole > (wholeLimit - digit) / 10) throw std::invalid_argument("parsing failed");
+							whole = whole * 10 + digit;
+						}
+					}
+
+					// digits without the point: the digit i has weight 10^(exponent + pointPos - 1 - i)
+					size_t digitCount = 0, pointPos = std::string_view::npos;
+					size_t firstNonZero = std::string_view::npos, lastNonZero = 0;
+					for (char c : mantissa)
+					{
+						if (c == '.' && pointPos == std::string_view::npos)
+						{
+							pointPos = digitCount;
+							continue;
+						}
+						if (c < '0' || c > '9') throw std::invalid_argument("parsing failed");
+						if (c != '0')
+						{
+							if (firstNonZero == std::string_view::npos) firstNonZero = digitCount;
+							lastNonZero = digitCount;
+						}
+						++digitCount;
+					}
+					if (digitCount == 0) throw std::invalid_argument("parsing failed");
+					if (pointPos == std::string_view::npos) pointPos = digitCount;
+					if (firstNonZero == std::string_view::npos) return U(0);
+
+					size_t significant = lastNonZero - firstNonZero + 1;
+					unsigned long long digits = 0;
+					const unsigned long long limit = std::is_integral_v<U>
+						? static_cast<unsigned long long>(std::numeric_limits<U>::max()) + (negative && std::is_signed_v<U> ? 1 : 0)
+						: 999999999999999ull;
+					size_t index = 0;
+					for (char c : mantissa)
+					{
+						if (c == '.') continue;
+						if (index >= firstNonZero && index <= lastNonZero)
+						{
+							unsigned digit = unsigned(c - '0');
+							if (digits > (limit - digit) / 10) throw std::invalid_argument("parsing failed");
+							digits = digits * 10 + digit;
+						}
+						++index;
+					}
+					long long scale = exponent + static_cast<long long>(pointPos) - 1 - static_cast<long long>(lastNonZero);
+
+					if constexpr (std::is_integral_v<U>)
+					{
+						if (scale < 0) throw std::invalid_argument("parsing failed");
+						for (; scale > 0; --scale)
+						{
+							if (digits > limit / 10) throw std::invalid_argument("parsing failed");
+							digits *= 10;
+						}
+						using unsigned_type = std::make_unsigned_t<U>;
+						return negative ? U(unsigned_type(0) - unsigned_type(digits)) : U(digits);
+					}
+					else
+					{
+						if (significant > 15 || scale > 22 || scale < -22) throw std::invalid_argument("range literal number is too precise");
+						double power = 1;
+						for (long long i = 0; i < (scale < 0 ? -scale : scale); ++i) power *= 10;
+						double value = scale < 0 ? double(digits) / power : double(digits) * power;
+						return U(negative ? -value : value);
+					}
+				}
+			};
+
+			// non-empty pieces of value between separators, trimmed
+			class item_reader
+			{
+			public:
+				constexpr item_reader(std::string_view value, std::string_view separator) : _rest(value), _separator(separator) {}
+
+				constexpr bool next(std::string_view& item)
+				{
+					while (!_done)
+					{
+						size_t pos = _separator.empty() ? std::string_view::npos : _rest.find(_separator);
+						std::string_view raw = _rest.substr(0, pos);
+						if (pos == std::string_view::npos) _done = true;
+						else _rest.remove_prefix(pos + _separator.size());
+						if (!raw.empty())
+						{
+							item = trim_item(raw);
+							return true;
+						}
+					}
+					return false;
+				}
+
+			private:
+				std::string_view _rest;
+				std::string_view _separator;
+				bool _done = false;
+			};
+
+			template<typename T, typename TNumbers>
+			constexpr bool try_parse_range_from_parts(std::string_view left, std::string_view right, const literal_parsing_options& options,
+				const TNumbers& numbers, range<T>& result)
 			{
-				bool isOpenInclusive = str::try_remove_prefix(left, brackets.range_open_inclusive);
-				bool isOpenExclusive = !isOpenInclusive && str::try_remove_prefix(left, brackets.range_open_exclusive);
-				bool isCloseInclusive = str::try_remove_suffix(right, brackets.range_close_inclusive);
-				bool isCloseExclusive = !isCloseInclusive && str::try_remove_suffix(right, brackets.range_close_exclusive);
+				bool isOpenInclusive = str::try_remove_prefix(left, options.range_open_inclusive);
+				bool isOpenExclusive = !isOpenInclusive && str::try_remove_prefix(left, options.range_open_exclusive);
+				bool isCloseInclusive = str::try_remove_suffix(right, options.range_close_inclusive);
+				bool isCloseExclusive = !isCloseInclusive && str::try_remove_suffix(right, options.range_close_exclusive);
 
 				if ((isOpenInclusive || isOpenExclusive) && (isCloseInclusive || isCloseExclusive))
 				{
-					auto from = str::parse<T>(left);
-					auto to = str::parse<T>(right);
+					auto from = numbers.template parse<T>(left);
+					auto to = numbers.template parse<T>(right);
 
-					return std::make_pair(make_range(
+					result = make_range(
 						normalize_range_bound(from, isOpenInclusive ? 0 : 1),
 						normalize_range_bound(to, isCloseInclusive ? 0 : -1)
-					), true);
+					);
+					return true;
+				}
+
+				return false;
+			}
+
+			// removes weight suffix of an item
+			template<typename TNumbers>
+			constexpr bool try_remove_weight(std::string_view& item, const literal_parsing_options& options, const TNumbers& numbers, double& weight)
+			{
+				size_t pos = item.rfind(options.weight_separator);
+				if (options.weight_separator.empty() || pos == std::string_view::npos) return false;
+				weight = numbers.template parse<double>(item.substr(pos + options.weight_separator.size()));
+				if (!(weight >= 0)) throw std::invalid_argument("range weight must be non-negative");
+				item = trim_item(item.substr(0, pos));
+				return true;
+			}
+
+			// removes distribution prefix like zipf(1.5)
+			template<typename TNumbers>
+			constexpr bool try_remove_distribution(std::string_view& value, const literal_parsing_options& options, const TNumbers& numbers,
+				range_array_opts& rnd_opts)
+			{
+				std::string_view prefixes[] = { options.distribution_skewed, options.distribution_zipf, options.distribution_geometric };
+				range_distribution distributions[] = { range_distribution::skewed, range_distribution::zipf, range_distribution::geometric };
+				for (size_t i = 0; i < 3; ++i)
+				{
+					std::string_view current = value;
+					if (prefixes[i].empty() || !str::try_remove_prefix(current, prefixes[i])) continue;
+					if (!str::try_remove_prefix(current, options.range_open_exclusive)) continue;
+					size_t close = current.find(options.range_close_exclusive);
+					if (close == std::string_view::npos) throw std::invalid_argument("distribution parameter is not closed");
+					rnd_opts.distribution = distributions[i];
+					rnd_opts.distribution_parameter = numbers.template parse<double>(current.substr(0, close));
+					value = trim_item(current.substr(close + options.range_close_exclusive.size()));
+					return true;
+				}
+				return false;
+			}
+
+			// the grammar of range arguments, shared by runtime values and literals.
+			// result is range_array or range_literal, numbers parse the values.
+			template<typename T, typename TResult, typename TNumbers>
+			constexpr void parse_range_items(std::string_view value, const literal_parsing_options& options, const TNumbers& numbers, TResult& result)
+			{
+				if (value.empty())
+				{
+					throw std::runtime_error("Can not get range from empty argument value.");
+				}
+
+				std::string_view current = value;
+
+				range_array_opts rnd_opts;
+
+				for (bool removed = true; removed;)
+				{
+					removed = try_remove_distribution(current, options, numbers, rnd_opts);
+					if (str::try_remove_prefix(current, options.rnd_mode_uniform_by_count))
+					{
+						rnd_opts.random_mode = range_random_mode::uniform_by_count;
+						removed = true;
+					}
+				}
+
+				str::try_remove_enclosed(current, options.rangeset_open, options.rangeset_close);
+
+				result.options() = rnd_opts;
+
+				// items are read with one item of lookahead: a range takes two of them
+				item_reader reader(current, options.items_separator);
+				std::string_view cur, next;
+				bool hasCur = reader.next(cur);
+				bool hasNext = hasCur && reader.next(next);
+
+				bool weighted = false;
+				while (hasCur)
+				{
+					double weight = 1;
+					if (hasNext)
+					{
+						std::string_view right = next;
+						bool hasWeight = try_remove_weight(right, options, numbers, weight);
+						range<T> rng{};
+						if (try_parse_range_from_parts<T>(cur, right, options, numbers, rng))
+						{
+							result.push_back(rng, weight);
+							weighted |= hasWeight;
+							hasCur = reader.next(cur);
+							hasNext = hasCur && reader.next(next);
+							continue;
+						}
+						weight = 1;
+					}
+
+					weighted |= try_remove_weight(cur, options, numbers, weight);
+					T single = numbers.template parse<T>(cur);
+					result.push_back(make_range(single, single), weight);
+					cur = next;
+					hasCur = hasNext;
+					hasNext = hasCur && reader.next(next);
 				}
 
-				return std::make_pair(range<T>(), false);
+				// any weight switches to weighted picking of ranges, items without weight have weight 1
+				if (weighted) result.options().random_mode = range_random_mode::weighted;
+			}
+
+			template<typename T>
+			range_array<T> parse_range(std::string_view value, const parsing_options & options)
+			{
+				range_array<T> result;
+				parse_range_items<T>(value, make_literal_options(options), runtime_numbers(), result);
+				return result;
 			}
 
-			template<typename T>
-			range_array<T> parse_range(std::string_view value, const parsing_options & options)
+			// parsed values of an argument, one per type, created on the first request.
+			// not thread-safe, as the rest of the arguments.
+			class typed_cache
 			{
-				if (value.empty())
+			public:
+				template<typename T, typename TFactory>
+				const T& get(TFactory&& factory) const
 				{
-					throw std::runtime_error("Can not get range from empty argument value.");
+					for (const auto& item : _items)
+					{
+						if (item.first == &tag<T>) return *static_cast<const T*>(item.second.get());
+					}
+					auto value = std::make_shared<const T>(factory());
+					_items.emplace_back(&tag<T>, value);
+					return *value;
+				}
+
+				// stores the value parsed elsewhere unless the value of T is already in the cache
+				template<typename T>
+				void put(const T& value) const
+				{
+					get<T>([&] { return value; });
 				}
 
-				const auto& brackets = options.brackets;
+			private:
+				// address of tag<T> identifies T
+				template<typename T>
+				static constexpr char tag = 0;
 
-				std::string_view current = value;
+				mutable std::vector<std::pair<const void*, std::shared_ptr<const void>>> _items;
+			};
 
-				range_array_opts rnd_opts;
+			struct argument_entry
+			{
+				std::string key;
+				std::string value;
+				typed_cache cache;
+			};
 
-				if (str::try_remove_prefix(current, options.prefixes.rnd_mode_uniform_by_count))
-				{
-					rnd_opts.random_mode = range_random_mode::uniform_by_count;
-				}
+			// value of an argument parsed before the initialization, put into the cache if the argument has this value
+			struct parsed_argument
+			{
+				std::string key;
+				std::string value;
+				std::function<void(const argument_entry& entry)> put;
+			};
 
-				str::try_remove_enclosed(current, brackets.rangeset_open, brackets.rangeset_close);
+			template<typename T, size_t N>
+			parsed_argument make_parsed_argument(std::string key, const range_literal<T, N>& literal)
+			{
+				return { std::move(key), std::string(literal.src()),
+					[ranges = literal.to_range_array()](const argument_entry& entry) { entry.cache.put(ranges); } };
+			}
 
-				auto result = range_array<T>(rnd_opts);
+			// argument declared by arguments_dictionary::declare
+			struct argument_declaration
+			{
+				std::string key;
+				std::string type_name;
+				// allowed values in the range syntax, empty if not restricted
+				std::string bounds;
+				std::string default_value;
+				bool has_default = false;
+				// puts the default ranges of a range literal into the cache, empty if the default is parsed as text
+				std::function<void(const argument_entry& entry)> put_default;
+				std::string description;
+				// parses the value and checks it against the bounds, throws std::invalid_argument on errors
+				void (*validate)(const argument_entry& entry, const argument_declaration& declaration) = nullptr;
+			};
 
-				auto parts = str::split(current, options.items_separator);
-				for (auto& part : parts)
-				{
-					part = str::trim(part);
-				}
+			template<typename T>
+			std::string type_name()
+			{
+				if constexpr (std::is_same_v<T, std::string>) return "string";
+				else if constexpr (std::is_floating_point_v<T>) return "double";
+				else if constexpr (std::is_integral_v<T>) return std::string(std::is_signed_v<T> ? "int" : "uint") + (sizeof(T) > 4 ? "64" : "");
+				else return "value";
+			}
 
-				for (size_t i = 0; i < parts.size(); ++i)
+			template<typename T>
+			void validate_argument(const argument_entry& entry, const argument_declaration& declaration)
+			{
+				try
 				{
-					auto cur = parts[i];
-					if (i + 1 < parts.size())
+					if constexpr (std::is_arithmetic_v<T>)
 					{
-						auto next = parts[i + 1];
-						range<T> rng;
-						bool isRange;
-						std::tie(rng, isRange) = try_parse_range_from_parts<T>(cur, next, brackets);
-
-						if (isRange)
+						// parsed into the same cache entry as argument_view::ranges
+						const auto& values = entry.cache.get<range_array<T>>([&] { return parse_range<T>(entry.value, parsing_options{}); });
+						if (declaration.bounds.empty()) return;
+						auto allowed = parse_range<T>(declaration.bounds, parsing_options{});
+						for (size_t i = 0; i < values.size(); ++i)
 						{
-							result.push_back(rng);
-							++i;
-							continue;
+							bool inside = false;
+							for (size_t j = 0; j < allowed.size() && !inside; ++j)
+							{
+								inside = allowed[j].from <= values[i].from && values[i].to <= allowed[j].to;
+							}
+							if (!inside) throw std::invalid_argument("out of " + declaration.bounds);
 						}
 					}
-
-					T current = str::parse<T>(cur);
-					result.push_back(make_range(current, current));
+					else if constexpr (!std::is_same_v<T, std::string>)
+					{
+						entry.cache.get<T>([&] { return str::parse<T>(entry.value); });
+					}
+				}
+				catch (const std::invalid_argument& e)
+				{
+					throw std::invalid_argument("argument " + entry.key + "=" + entry.value + ": " + e.what());
 				}
-
-				return result;
 			}
-
 		}
 
 
 		class argument_view
 		{
 		private:
-			const std::string* _rawValue;
+			const impl_arg_parsing::argument_entry* _entry;
 			const std::string& _rw() const
 			{
-				if (!_rawValue) throw std::logic_error("value not exists");
-				return *_rawValue;
+				if (!_entry) throw std::logic_error("value not exists");
+				return _entry->value;
 			}
 
 		public:
-			argument_view() : _rawValue(nullptr) {}
+			argument_view() : _entry(nullptr) {}
 
-			explicit argument_view(const std::string& value)
-				: _rawValue(&value)
+			explicit argument_view(const impl_arg_parsing::argument_entry& entry)
+				: _entry(&entry)
 			{}
 
 			explicit operator bool() const
 			{
-				return _rawValue;
+				return _entry;
 			}
 
+			// parsed once per type, later calls take the value from the cache of the argument
 			template<typename T>
-			T value() const { return str::parse<T>(_rw()); }
+			T value() const
+			{
+				const std::string& raw = _rw();
+				return _entry->cache.get<T>([&] { return str::parse<T>(raw); });
+			}
 
 			template<typename T>
 			T value_or(const T& default_value) const
 			{
-				if (_rawValue)
+				if (_entry)
 				{
-					return str::parse<T>(*_rawValue);
+					return value<T>();
 				}
 				else
 				{
@@ -612,15 +4716,30 @@ namespace problib
 				}
 			}
 
+			// parsed once per type with the default options,
+			// the reference is valid until the arguments are reset
 			template<typename T>
-			range_array<T> ranges() const { return ranges<T>(parsing_options{}); }
+			const range_array<T>& ranges() const
+			{
+				const std::string& raw = _rw();
+				return _entry->cache.get<range_array<T>>([&] { return impl_arg_parsing::parse_range<T>(raw, parsing_options{}); });
+			}
 
 			template<typename T, typename U>
 			range_array<T> ranges_or(U&& default_value) const
 			{
+				if (_entry) return ranges<T>();
 				return ranges_or<T>(std::forward<U>(default_value), parsing_options{});
 			}
 
+			// the default is converted without parsing
+			template<typename T, size_t N>
+			range_array<T> ranges_or(const range_literal<T, N>& default_value) const
+			{
+				if (_entry) return ranges<T>();
+				return default_value.to_range_array();
+			}
+
 			template<typename T>
 			range_array<T> ranges(const parsing_options& opts) const
 			{
@@ -630,9 +4749,9 @@ namespace problib
 			template<typename T>
 			range_array<T> ranges_or(std::string_view default_value, const parsing_options& opts) const
 			{
-				if (_rawValue)
+				if (_entry)
 				{
-					return impl_arg_parsing::parse_range<T>(*_rawValue, opts);
+					return impl_arg_parsing::parse_range<T>(_entry->value, opts);
 				}
 				else
 				{
@@ -644,9 +4763,9 @@ namespace problib
 			std::enable_if_t<std::is_convertible_v<U&&, range_array<T>> || std::is_convertible_v<U&&, range<T>>, range_array<T>>
 				ranges_or(U&& default_value, const parsing_options& opts) const
 			{
-				if (_rawValue)
+				if (_entry)
 				{
-					return impl_arg_parsing::parse_range<T>(*_rawValue, opts);
+					return impl_arg_parsing::parse_range<T>(_entry->value, opts);
 				}
 				else
 				{
@@ -667,10 +4786,17 @@ namespace problib
 			}
 
 #ifdef _TESTLIB_H_
+			// compiled once, the reference is valid until the arguments are reset
+			const compiled_pattern& pattern() const
+			{
+				const std::string& raw = _rw();
+				return _entry->cache.get<compiled_pattern>([&] { return compiled_pattern(raw); });
+			}
 
+			// the same as rnd.next(value) of testlib
 			std::string rnd_from_pattern() const
 			{
-				return rnd.next(_rw());
+				return pattern().get_rnd();
 			}
 #endif
 
@@ -678,26 +4804,174 @@ namespace problib
 
 		template<> std::string argument_view::value() const { return _rw(); }
 
+		// parses range argument syntax at compile time when used in a constant expression,
+		// syntax errors are reported by the compiler then. for example:
+		// constexpr auto defaultN = problib::parse_range_literal<int64>("{1,[43,65]}");
+		// args["n"].ranges_or<int64>(defaultN);
+		template<typename T, size_t N = 16>
+		constexpr range_literal<T, N> parse_range_literal(std::string_view value, const literal_parsing_options& options = literal_parsing_options())
+		{
+			range_literal<T, N> result(value);
+			impl_arg_parsing::parse_range_items<T>(value, options, impl_arg_parsing::literal_numbers(), result);
+			return result;
+		}
+
+		class arguments_dictionary;
+
+		// handle of a declared argument, see arguments_dictionary::declare.
+		// access is O(1): the argument is found by its index in the schema.
+		template<typename T>
+		class argument
+		{
+		public:
+			argument(const arguments_dictionary& dict, size_t index) : _dict(&dict), _index(index) {}
+
+			const std::string& key() const;
+			argument_view view() const;
+
+			T value() const { return view().template value<T>(); }
+			const range_array<T>& ranges() const { return view().template ranges<T>(); }
+
+#ifdef _TESTLIB_H_
+			T get_rnd() const { return ranges().get_rnd(); }
+#endif
+
+		private:
+			const arguments_dictionary* _dict;
+			size_t _index;
+		};
+
 		class arguments_dictionary
 		{
 		public:
 			using map_type = std::map<std::string, std::string, std::less<>>;
 
 		private:
-			map_type _dict;
+			// sorted by key, each entry keeps its parsed values
+			std::vector<impl_arg_parsing::argument_entry> _dict;
+			// declared arguments and their entries, in the order of declaration
+			std::vector<impl_arg_parsing::argument_declaration> _schema;
+			std::vector<const impl_arg_parsing::argument_entry*> _declared;
+			// values of the next reset parsed at compile time, see preset
+			std::vector<impl_arg_parsing::parsed_argument> _parsed;
+			bool _initialized = false;
+
+			const impl_arg_parsing::argument_entry* _find(std::string_view key) const
+			{
+				auto it = std::lower_bound(_dict.begin(), _dict.end(), key,
+					[](const impl_arg_parsing::argument_entry& entry, std::string_view value) { return entry.key < value; });
+				return it != _dict.end() && it->key == key ? &*it : nullptr;
+			}
 
 		public:
+			// drops the parsed values, views and references to them become invalid.
+			// if arguments are declared, values are checked against the declarations
+			// and std::invalid_argument is thrown for unknown, missing or invalid arguments.
 			void reset(map_type&& values)
 			{
-				_dict = std::move(values);
+				auto parsed = std::move(_parsed);
+				_parsed.clear();
+				for (const auto& declaration : _schema)
+				{
+					if (declaration.has_default) values.emplace(declaration.key, declaration.default_value);
+					if (declaration.put_default) parsed.push_back({ declaration.key, declaration.default_value, declaration.put_default });
+				}
+				if (!_schema.empty())
+				{
+					for (const auto& [key, value] : values)
+					{
+						bool known = std::any_of(_schema.begin(), _schema.end(),
+							[&](const impl_arg_parsing::argument_declaration& declaration) { return declaration.key == key; });
+						if (!known) throw std::invalid_argument("unknown argument " + key);
+					}
+				}
+
+				_dict.clear();
+				_dict.reserve(values.size());
+				for (auto& [key, value] : values)
+				{
+					_dict.push_back({ key, std::move(value), {} });
+				}
+				for (const auto& item : parsed)
+				{
+					auto entry = _find(item.key);
+					if (entry && entry->value == item.value) item.put(*entry);
+				}
+
+				_declared.clear();
+				_initialized = true;
+				for (const auto& declaration : _schema)
+				{
+					auto entry = _find(declaration.key);
+					if (!entry) throw std::invalid_argument("missing argument " + declaration.key);
+					declaration.validate(*entry, declaration);
+					_declared.push_back(entry);
+				}
+			}
+
+			// declares argument of type T: values are parsed as ranges of T (or as T for other types),
+			// bounds restrict the ranges and are written in the same syntax, for example "[1,1e5]".
+			// declarations must precede the initialization, after them unknown arguments are rejected.
+			template<typename T>
+			argument<T> declare(std::string key, std::string bounds = "", std::string description = "")
+			{
+				return _declare<T>(std::move(key), std::move(bounds), nullptr, std::move(description));
+			}
+
+			template<typename T>
+			argument<T> declare_or(std::string key, std::string bounds, std::string defaultValue, std::string description = "")
+			{
+				return _declare<T>(std::move(key), std::move(bounds), &defaultValue, std::move(description));
+			}
+
+			// the default is not parsed when it is used, for example:
+			// declare_or("n", "[1,1e18]", parse_range_literal<int64>("[1,100]"))
+			template<typename T, size_t N>
+			argument<T> declare_or(std::string key, std::string bounds, const range_literal<T, N>& defaultValue, std::string description = "")
+			{
+				std::string defaultText(defaultValue.src());
+				auto result = _declare<T>(key, std::move(bounds), &defaultText, std::move(description));
+				_schema.back().put_default = impl_arg_parsing::make_parsed_argument(std::move(key), defaultValue).put;
+				return result;
+			}
+
+			// if the next reset sets the argument to the text of the literal, its ranges are taken from the literal
+			template<typename T, size_t N>
+			void preset(std::string key, const range_literal<T, N>& value)
+			{
+				_parsed.push_back(impl_arg_parsing::make_parsed_argument(std::move(key), value));
+			}
+
+			const impl_arg_parsing::argument_entry& declared_entry(size_t index) const
+			{
+				if (index >= _declared.size()) throw std::logic_error("arguments are not initialized");
+				return *_declared[index];
+			}
+
+			size_t declared_count() const { return _schema.size(); }
+			const impl_arg_parsing::argument_declaration& declaration(size_t index) const { return _schema[index]; }
+
+			// description of the declared arguments
+			std::string help() const
+			{
+				std::string result = "arguments:\n";
+				for (const auto& declaration : _schema)
+				{
+					result += "  " + declaration.key + "=<" + declaration.type_name + ">";
+					if (!declaration.bounds.empty()) result += " in " + declaration.bounds;
+					if (declaration.has_default) result += ", default " + declaration.default_value;
+					if (!declaration.description.empty()) result += "  " + declaration.description;
+					result += "\n";
+				}
+				return result;
 			}
 
 			argument_view operator[](const std::string_view& key) const
 			{
-				auto it = _dict.find(key);
-				if (it != _dict.end())
+				auto entry = _find(key);
+				if (entry)
 				{
-					return argument_view(it->second);
+					return argument_view(*entry);
 				}
 				else
 				{
@@ -707,13 +4981,41 @@ namespace problib
 
 			bool has(const std::string_view& key) const
 			{
-				return _dict.find(key) != _dict.end();
+				return _find(key) != nullptr;
+			}
+
+		private:
+			template<typename T>
+			argument<T> _declare(std::string key, std::string bounds, const std::string* defaultValue, std::string description)
+			{
+				if (_initialized) throw std::logic_error("argument " + key + " must be declared before the initialization");
+				for (const auto& declaration : _schema)
+				{
+					if (declaration.key == key) throw std::logic_error("argument " + key + " is declared twice");
+				}
+				impl_arg_parsing::argument_declaration declaration;
+				declaration.key = std::move(key);
+				declaration.type_name = impl_arg_parsing::type_name<T>();
+				declaration.bounds = std::move(bounds);
+				declaration.has_default = defaultValue != nullptr;
+				if (defaultValue) declaration.default_value = *defaultValue;
+				declaration.description = std::move(description);
+				declaration.validate = &impl_arg_parsing::validate_argument<T>;
+				_schema.push_back(std::move(declaration));
+				return argument<T>(*this, _schema.size() - 1);
 			}
 		};
 
+		template<typename T>
+		const std::string& argument<T>::key() const { return _dict->declaration(_index).key; }
+
+		template<typename T>
+		argument_view argument<T>::view() const { return argument_view(_dict->declared_entry(_index)); }
+
 	}
 
 	using arguments::argument_view;
+	using arguments::parse_range_literal;
 	using arguments::arguments_dictionary;
 
 	namespace impl
@@ -722,7 +5024,8 @@ namespace problib
 
 		std::vector<std::string_view> split_args(std::string_view args)
 		{
-			return str::split_if(args, &isspace);
+			static constexpr str::char_class spaces = str::char_class::space();
+			return str::split_if(args, spaces);
 		}
 
 		std::pair<std::string_view, std::string_view> parse_arg(std::string_view key_value)
@@ -755,12 +5058,276 @@ namespace problib
 			return values;
 		}
 
+#ifdef _TESTLIB_H_
+		// test of a gen-script line "<generator> <args...> > <test>"
+		struct gen_script_test
+		{
+			std::vector<std::string> args;
+			std::string test;
+		};
+
+		// name of the generator by its path: without directories and extension
+		std::string_view generator_name(std::string_view path)
+		{
+			size_t slash = path.find_last_of("/\\");
+			if (slash != std::string_view::npos) path.remove_prefix(slash + 1);
+			size_t dot = path.find_last_of('.');
+			return dot == std::string_view::npos || dot == 0 ? path : path.substr(0, dot);
+		}
+
+		// tests of the generator in gen-script, "$" is the test after the previous line.
+		// lines of other generators are skipped but advance the numbering.
+		std::vector<gen_script_test> parse_gen_script(std::string_view script, std::string_view generator)
+		{
+			std::vector<gen_script_test> result;
+			long long lastTest = 0;
+			for (auto line : str::split_view(script, "\n"))
+			{
+				auto tokens = split_args(line);
+				if (tokens.empty()) continue;
+
+				auto redirect = std::find_if(tokens.begin(), tokens.end(), [](std::string_view token) { return str::starts_with(token, ">"); });
+				std::string_view test = redirect == tokens.end() ? std::string_view() : redirect->substr(1);
+				if (redirect != tokens.end() && test.empty() && redirect + 1 != tokens.end()) test = redirect[1];
+				if (test.empty()) throw std::invalid_argument("gen-script line has no test: " + std::string(line));
+
+				lastTest = test == "$" ? lastTest + 1 : str::parse<long long>(test);
+				if (generator_name(tokens[0]) != generator_name(generator)) continue;
+
+				gen_script_test current;
+				current.args.assign(tokens.begin() + 1, redirect);
+				current.test = std::to_string(lastTest);
+				result.push_back(std::move(current));
+			}
+			return result;
+		}
+
+		std::string read_file(const std::string& path)
+		{
+			std::FILE* file = std::fopen(path.c_str(), "rb");
+			if (!file) throw std::runtime_error("Can not open file " + path + ".");
+			std::string result;
+			char buffer[1 << 12];
+			for (size_t read; (read = std::fread(buffer, 1, sizeof(buffer), file)) > 0;) result.append(buffer, read);
+			std::fclose(file);
+			return result;
+		}
+
+		// points stdout to the file as shell redirection does, restores it on destruction.
+		// stdout keeps its text or binary mode, so line endings are the same as in a separate run.
+		class stdout_redirect
+		{
+		public:
+			stdout_redirect()
+			{
+				_flush();
+#ifdef _WIN32
+				_saved = _dup(_fd(stdout));
+				_mode = _setmode(_fd(stdout), _O_TEXT);
+				_setmode(_fd(stdout), _mode);
+#else
+				_saved = dup(_fd(stdout));
+#endif
+				if (_saved < 0) throw std::runtime_error("Can not duplicate stdout.");
+			}
+
+			stdout_redirect(const stdout_redirect&) = delete;
+			stdout_redirect& operator=(const stdout_redirect&) = delete;
+
+			~stdout_redirect()
+			{
+				_flush();
+				_assign(_saved);
+#ifdef _WIN32
+				_close(_saved);
+#else
+				close(_saved);
+#endif
+			}
+
+			void to(const std::string& path)
+			{
+				_flush();
+				std::FILE* file = std::fopen(path.c_str(), "wb");
+				if (!file) throw std::runtime_error("Can not open file " + path + ".");
+				_assign(_fd(file));
+				std::fclose(file);
+#ifdef _WIN32
+				// the duplicated descriptor takes the binary mode of the file
+				_setmode(_fd(stdout), _mode);
+#endif
+			}
+
+		private:
+			int _saved;
+#ifdef _WIN32
+			int _mode;
+#endif
+
+			static void _flush()
+			{
+				std::cout.flush();
+				std::fflush(stdout);
+			}
+
+			static int _fd(std::FILE* file)
+			{
+#ifdef _WIN32
+				return _fileno(file);
+#else
+				return fileno(file);
+#endif
+			}
+
+			static void _assign(int fd)
+			{
+#ifdef _WIN32
+				_dup2(fd, _fd(stdout));
+#else
+				dup2(fd, _fd(stdout));
+#endif
+			}
+		};
+
+		size_t hardware_jobs()
+		{
+#ifdef _WIN32
+			return std::max(1u, std::thread::hardware_concurrency());
+#else
+			long count = sysconf(_SC_NPROCESSORS_ONLN);
+			return count > 0 ? size_t(count) : 1;
+#endif
+		}
+
+#ifdef _WIN32
+		// argument quoted for the command line of a new process, as parsed by the CRT
+		std::string quote_arg(const std::string& arg)
+		{
+			std::string result = "\"";
+			size_t slashes = 0;
+			for (char c : arg)
+			{
+				if (c == '\\')
+				{
+					++slashes;
+					continue;
+				}
+				result.append(c == '"' ? slashes * 2 + 1 : slashes, '\\');
+				slashes = 0;
+				result += c;
+			}
+			result.append(slashes * 2, '\\');
+			return result + "\"";
+		}
+
+		// runs jobs copies of this executable with arguments --script=<script> --worker=<i>/<jobs>,
+		// shares of workers which can not be started are run by runShare(i, jobs) in this process.
+		// returns exit code of a failed worker or 0.
+		template<typename TRunShare>
+		int run_spawned(const std::string& script, size_t jobs, TRunShare runShare)
+		{
+			char* path = nullptr;
+			if (_get_pgmptr(&path) != 0 || !path) throw std::runtime_error("Can not get path of the generator.");
+			std::string quotedPath = quote_arg(path);
+			std::string scriptArg = quote_arg("--script=" + script);
+
+			std::cout.flush();
+			std::fflush(stdout);
+			std::vector<intptr_t> workers;
+			std::vector<size_t> notStarted;
+			for (size_t i = 0; i < jobs; ++i)
+			{
+				std::string workerArg = "--worker=" + std::to_string(i) + "/" + std::to_string(jobs);
+				const char* workerArgv[] = { quotedPath.c_str(), scriptArg.c_str(), workerArg.c_str(), nullptr };
+				intptr_t worker = _spawnv(_P_NOWAIT, path, workerArgv);
+				if (worker == -1) notStarted.push_back(i);
+				else workers.push_back(worker);
+			}
+
+			int result = 0;
+			for (size_t i : notStarted)
+			{
+				int code = runShare(i, jobs);
+				if (!result) result = code;
+			}
+			for (intptr_t worker : workers)
+			{
+				int code = EXIT_FAILURE;
+				if (_cwait(&code, worker, 0) == -1) code = EXIT_FAILURE;
+				if (!result) result = code;
+			}
+			return result;
+		}
+#else
+		// runs task(i) for each i in [0, count) in forked processes, each process takes the next index when done.
+		// every process has its own copy of globals like rnd and args.
+		// task returns exit code of the test, returns the first failed code or 0.
+		template<typename TTask>
+		int run_forked(size_t count, size_t jobs, TTask task)
+		{
+			void* shared = mmap(nullptr, sizeof(std::atomic<size_t>), PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+			if (shared == MAP_FAILED) throw std::runtime_error("Can not map shared memory.");
+			auto next = new (shared) std::atomic<size_t>(0);
+
+			std::cout.flush();
+			std::fflush(stdout);
+			std::vector<pid_t> workers;
+			for (size_t i = 0; i < jobs; ++i)
+			{
+				pid_t pid = fork();
+				if (pid < 0) break;
+				if (pid == 0)
+				{
+					int code = 0;
+					for (size_t index; (index = next->fetch_add(1)) < count;)
+					{
+						int taskCode = task(index);
+						if (!code) code = taskCode;
+					}
+					std::cout.flush();
+					std::fflush(stdout);
+					_exit(code);
+				}
+				workers.push_back(pid);
+			}
+
+			int result = 0;
+			// no worker started, the tasks are run here
+			if (workers.empty())
+			{
+				for (size_t index; (index = next->fetch_add(1)) < count;)
+				{
+					int code = task(index);
+					if (!result) result = code;
+				}
+			}
+
+			for (pid_t pid : workers)
+			{
+				int status = 0;
+				waitpid(pid, &status, 0);
+				int code = WIFEXITED(status) ? WEXITSTATUS(status) : EXIT_FAILURE;
+				if (!result) result = code;
+			}
+			munmap(shared, sizeof(std::atomic<size_t>));
+			return result;
+		}
+#endif
+#endif
+
 		class generator_root : public arguments_dictionary
 		{
 		public:
+			// with declared arguments, --help prints them and exits
 			void init(const std::vector<std::string_view>& args)
 			{
-				reset(make_args_map(args));
+				auto values = make_args_map(args);
+				if (declared_count() && values.count("--help") && values.size() == 1)
+				{
+					std::fputs(help().c_str(), stdout);
+					std::exit(0);
+				}
+				reset(std::move(values));
 			}
 
 			void init(int argc, args_t argv)
@@ -793,11 +5360,140 @@ namespace problib
 				auto splitted = split_args(args);
 				initRegisterGen(argc, argv, std::vector<std::string>(splitted.begin(), splitted.end()));
 			}
+
+			// arguments are pairs of a key and a range literal, their ranges are not parsed again, for example:
+			// initRegisterGen(argc, argv, "n", parse_range_literal<int64>("[1,100]"), "k", parse_range_literal<int>("{1,5}"))
+			template<typename T, size_t N, typename... TRest>
+			void initRegisterGen(int argc, args_t argv, std::string_view key, const arguments::range_literal<T, N>& value, const TRest&... rest)
+			{
+				std::vector<std::string> values;
+				_preset_all(values, key, value, rest...);
+				initRegisterGen(argc, argv, values);
+			}
+
+			// runs body as the generator. with arguments --script=<gen-script> [--jobs=<count>], runs body
+			// for each test of this generator in the script: arguments and rnd are set as by a separate run
+			// with the arguments of the line, output goes to <test>.in.
+			// other state is not reset between tests: globals, function-local statics, dynamic_modint moduli, etc.
+			// keep values of the previous test, so the output is the same as of separate runs only if body
+			// sets up all such state it uses by itself.
+			// tests are run in this process, or by count worker processes (0 is all cores): forked where fork
+			// is available, otherwise new processes of the generator, each running its share of the tests.
+			// an exception of a test is printed to stderr and the other tests are still run, the exit code
+			// is EXIT_FAILURE then. testlib failures end the process running the test as in a separate run.
+			template<typename TBody>
+			int run(int argc, args_t argv, TBody body)
+			{
+				std::string_view script, jobs, worker;
+				bool batch = argc >= 2 && argc <= 4;
+				for (int i = 1; batch && i < argc; ++i)
+				{
+					std::string_view arg = argv[i];
+					if (str::try_remove_prefix(arg, "--script=")) script = arg;
+					else if (str::try_remove_prefix(arg, "--jobs=")) jobs = arg;
+					else if (str::try_remove_prefix(arg, "--worker=")) worker = arg;
+					else batch = false;
+				}
+				if (!batch || script.empty())
+				{
+					initRegisterGen(argc, argv);
+					body();
+					return 0;
+				}
+
+				auto tests = parse_gen_script(read_file(std::string(script)), argv[0]);
+				auto runTest = [&](const gen_script_test& test, stdout_redirect& redirect)
+				{
+					try
+					{
+						std::vector<const char*> testArgv{ argv[0] };
+						for (const auto& arg : test.args) testArgv.push_back(arg.c_str());
+						initRegisterGen(testArgv.size(), testArgv.data());
+						redirect.to(test.test + ".in");
+						body();
+						return 0;
+					}
+					catch (const std::exception& e)
+					{
+						std::fprintf(stderr, "test %s: %s\n", test.test.c_str(), e.what());
+						return EXIT_FAILURE;
+					}
+				};
+				// runs tests first, first + step, ...
+				auto runShare = [&](size_t first, size_t step)
+				{
+					int result = 0;
+					stdout_redirect redirect;
+					for (size_t i = first; i < tests.size(); i += step)
+					{
+						int code = runTest(tests[i], redirect);
+						if (!result) result = code;
+					}
+					return result;
+				};
+
+				if (!worker.empty())
+				{
+					size_t slash = worker.find('/');
+					size_t index = slash == std::string_view::npos ? 0 : str::parse<size_t>(worker.substr(0, slash));
+					size_t count = slash == std::string_view::npos ? 0 : str::parse<size_t>(worker.substr(slash + 1));
+					if (index >= count) throw std::invalid_argument("--worker must be <index>/<count> with index less than count.");
+					return runShare(index, count);
+				}
+
+				size_t jobCount = jobs.empty() ? 1 : str::parse<size_t>(jobs);
+				if (!jobCount) jobCount = hardware_jobs();
+				jobCount = std::min(jobCount, tests.size());
+				if (jobCount > 1)
+				{
+#ifdef _WIN32
+					return run_spawned(std::string(script), jobCount, runShare);
+#else
+					return run_forked(tests.size(), jobCount, [&](size_t index)
+					{
+						stdout_redirect redirect;
+						return runTest(tests[index], redirect);
+					});
+#endif
+				}
+				return runShare(0, 1);
+			}
 #endif
+
+		private:
+			void _preset_all(std::vector<std::string>&) {}
+
+			template<typename T, size_t N, typename... TRest>
+			void _preset_all(std::vector<std::string>& values, std::string_view key, const arguments::range_literal<T, N>& value, const TRest&... rest)
+			{
+				values.push_back(std::string(key) + "=" + std::string(value.src()));
+				preset(std::string(key), value);
+				_preset_all(values, rest...);
+			}
 		};
 	}
 
 	impl::generator_root args;
+
+	// declares argument of the generator, see arguments_dictionary::declare.
+	// for example: const auto n = problib::arg<int64>("n", "[1,1e5]");
+	template<typename T>
+	arguments::argument<T> arg(std::string key, std::string bounds = "", std::string description = "")
+	{
+		return args.declare<T>(std::move(key), std::move(bounds), std::move(description));
+	}
+
+	template<typename T>
+	arguments::argument<T> arg_or(std::string key, std::string bounds, std::string defaultValue, std::string description = "")
+	{
+		return args.declare_or<T>(std::move(key), std::move(bounds), std::move(defaultValue), std::move(description));
+	}
+
+	template<typename T, size_t N>
+	arguments::argument<T> arg_or(std::string key, std::string bounds, const arguments::range_literal<T, N>& defaultValue, std::string description = "")
+	{
+		return args.declare_or(std::move(key), std::move(bounds), defaultValue, std::move(description));
+	}
 }
 
 #endif
\ No newline at end of file
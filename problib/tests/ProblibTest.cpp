@@ -1,5 +1,5 @@
-﻿#include "..\external\testlib\testlib.h"
-#include "..\src\problib.h"
+﻿#include "../external/testlib/testlib.h"
+#include "../src/problib.h"
 #include <iostream>
 
 using namespace problib;
@@ -23,6 +23,443 @@ int main(int argc, char* argv[])
 
 	std::cerr << make_printer(v.begin(), v.end()) << std::endl;
 
+	std::vector<long long> printed{ -9223372036854775807LL - 1, 0, 99, 100, 4294967296LL };
+	std::ostringstream printerOut;
+	printerOut << make_printer(printed, ",") << ' ' << make_printer(std::vector<double>{ 0.1, 2.5e-7 });
+	ensuref(printerOut.str() == "-9223372036854775808,0,99,100,4294967296 0.1 2.5e-07", "make_printer");
+	ensuref(str::to_string(-1234567) == "-1234567" && str::to_string(1e100) == "1e+100", "to_string");
+
+	std::string written;
+	{
+		io::writer out(written, 16);
+		out << 42 << ' ' << -7LL << ' ' << 0.25 << ' ' << "text" << '\n' << make_printer(v, ",") << '\n';
+		out.precision(3).float_format(std::chars_format::fixed).write_range(std::vector<double>{ 1, 2.5 });
+	}
+	ensuref(written == "42 -7 0.25 text\n1,2,3,4,5,6\n1.000 2.500", "io::writer");
+
+	static_assert(modint1000000007(2).pow(1000000006) == 1);
+	static_assert((modint<1000000000000000003ULL>(3) * modint<1000000000000000003ULL>(5)).val() == 15, "constexpr modint with 64-bit modulus");
+	ensuref(pow(3, 4) == 81 && pow_mod(-2LL, 3, 7LL) == 6, "pow");
+	ensuref(pow_mod(3ULL, 1000000000000000000ULL, 18446744073709551557ULL) == 4014180641660839766ULL, "pow_mod 64-bit");
+	dynamic_modint<>::set_mod(1000000007);
+	ensuref((dynamic_modint<>(-1) * dynamic_modint<>(2).inv()).val() == 500000003, "dynamic_modint");
+	{
+		// the extended Euclid coefficients do not fit t0 + m for moduli above 2^63
+		using modint_large = modint<18446744073709551557ULL>;
+		static_assert((modint_large(2) * modint_large(2).inv()).val() == 1, "constexpr modint inverse with 64-bit modulus");
+		dynamic_modint<1>::set_mod(18446744073709551557ULL);
+		for (int i = 0; i < 1000; ++i)
+		{
+			// even values up to 2^64 - 2 are never divisible by the odd modulus
+			unsigned long long a = static_cast<unsigned long long>(rnd.next(1LL, LLONG_MAX)) * 2;
+			ensuref((modint_large(a) * modint_large(a).inv()).val() == 1 && (modint_large(5) / modint_large(a) * modint_large(a)).val() == 5
+				&& (dynamic_modint<1>(a) / dynamic_modint<1>(a)).val() == 1, "modint inverse with 64-bit modulus");
+		}
+	}
+
+	range_array<long long> pieces100;
+	for (int i = 0; i < 100; ++i) pieces100.push_back(make_range(i * 1000LL, i * 1000LL + 9));
+	ensuref(pieces100.total_length() == 1000, "range_array total_length");
+	for (int i = 0; i < 1000; ++i) ensuref(pieces100.get_rnd() % 1000 < 10, "range_array get_rnd");
+	pieces100[0] = make_range(-5LL, 4LL);
+	pieces100.push_back(make_range(-100LL, -91LL));
+	ensuref(pieces100.total_length() == 1010, "range_array index invalidation");
+	for (int i = 0; i < 1000; ++i)
+	{
+		long long bounded = pieces100.get_rnd(5005, 7003);
+		ensuref(bounded >= 5005 && bounded <= 7003 && bounded % 1000 < 10, "range_array bounded get_rnd");
+	}
+	range_array<long long> orderedPieces;
+	for (int i = 0; i < 10; ++i) orderedPieces.push_back(make_range(i * 1000LL, i * 1000LL + 9));
+	ensuref(orderedPieces.get_rnd(7008, 7002) == 7008 && pieces100.get_rnd(7008, 7002) == 7008, "range_array reversed bounds");
+
+	auto domain = range_set<long long>(args["k"].ranges<long long>()) | range_set<long long>(make_range(66LL, 1000000000000LL));
+	ensuref(domain.size() == 3 && domain.total_length() == 1000000000000LL - 43 + 5, "range_set union");
+	auto holes = domain.complement(0, 100) - range_set<long long>(make_range(0LL, 0LL));
+	ensuref(holes.size() == 2 && holes.contains(4) && !holes.contains(33) && holes.count_less(40) == 35, "range_set algebra");
+
+	auto kValues = arg_k.values();
+	std::vector<int> kFilled(kValues.size());
+	kValues.fill(0, kFilled.data(), kFilled.size());
+	ensuref(kFilled == arg_k.get_all_values() && std::vector<int>(kValues.begin(), kValues.end()) == kFilled, "range_array values");
+	range_array<long long> hugeRange(make_range(1LL, 1000000000000LL));
+	auto hugeValues = hugeRange.values();
+	ensuref(hugeValues.size() == 1000000000000LL && hugeValues[999999999999LL] == 1000000000000LL, "range_array huge values");
+
+	{
+		random_t saved = rnd;
+		std::vector<int> scalar(300);
+		for (auto& value : scalar) value = arg_k.get_rnd();
+		long long next = rnd.next(1000000000LL);
+		rnd = saved;
+		ensuref(arg_k.get_rnd_n(scalar.size()) == scalar && rnd.next(1000000000LL) == next, "range_array get_rnd_n");
+
+		saved = rnd;
+		std::vector<long long> wide(100);
+		for (auto& value : wide) value = make_range(-5LL, 1000000000000LL).get_rnd();
+		rnd = saved;
+		std::vector<long long> wideFilled(wide.size());
+		make_range(-5LL, 1000000000000LL).fill_rnd(wideFilled.begin(), wideFilled.end());
+		ensuref(wideFilled == wide, "range fill_rnd");
+	}
+
+	auto distinct = hugeRange.sample_distinct(1000);
+	ensuref(distinct.size() == 1000 && std::adjacent_find(distinct.begin(), distinct.end(), std::greater_equal<long long>()) == distinct.end()
+		&& distinct.front() >= 1, "range_array sample_distinct");
+	auto kShuffled = arg_k.sample_distinct(arg_k.total_length(), false);
+	std::sort(kShuffled.begin(), kShuffled.end());
+	ensuref(kShuffled == range_set<int>(arg_k).to_range_array().get_all_values(), "range_array sample_distinct whole domain");
+
+	range_domain<long long> ids(make_range(1LL, 1000000000000000000LL));
+	ensuref(ids.exclude(5) && !ids.exclude(5) && !ids.exclude(0) && ids.nth(4) == 6 && ids.count_less(7) == 5, "range_domain exclude");
+	long long taken = ids.take();
+	ensuref(!ids.contains(taken) && ids.total_length() == 1000000000000000000LL - 2, "range_domain take");
+
+	range_domain<int> sparse(make_range(1, 1000));
+	for (int value = 1; value <= 1000; ++value)
+	{
+		if (value % 100 != 0) sparse.exclude(value);
+	}
+	int sparseValue = sparse.get_rnd();
+	ensuref(sparse.total_length() == 10 && sparseValue % 100 == 0 && sparse.nth(9) == 1000, "range_domain mostly excluded");
+
+	auto weightedArg = arguments::impl_arg_parsing::parse_range<int>("{[1,10]:3,[100,200]:0,7}", arguments::parsing_options{});
+	ensuref(weightedArg.options().random_mode == range_random_mode::weighted && weightedArg.size() == 3
+		&& weightedArg.weight(0) == 3 && weightedArg.weight(1) == 0 && weightedArg.weight(2) == 1, "weighted range parsing");
+	for (int i = 0; i < 100; ++i)
+	{
+		int value = weightedArg.get_rnd();
+		ensuref((value >= 1 && value <= 10) || value == 7, "weighted range_array get_rnd");
+	}
+	auto orderedWeights = arguments::impl_arg_parsing::parse_range<int>("{[1,10]:1,[20,30]:0,[40,50]:3}", arguments::parsing_options{});
+	for (int i = 0; i < 100; ++i)
+	{
+		int unordered = weightedArg.get_rnd(5, 150);
+		int ordered = orderedWeights.get_rnd(5, 45);
+		ensuref(((unordered >= 5 && unordered <= 10) || unordered == 7) && ((ordered >= 5 && ordered <= 10) || (ordered >= 40 && ordered <= 45)),
+			"weighted range_array bounded get_rnd");
+	}
+	auto zipfArg = arguments::impl_arg_parsing::parse_range<long long>("!zipf(1.5){[1,1000000000000],[-3,-1]}", arguments::parsing_options{});
+	ensuref(zipfArg.options().random_mode == range_random_mode::uniform_by_count && zipfArg.options().distribution == range_distribution::zipf
+		&& zipfArg.options().distribution_parameter == 1.5, "distribution parsing");
+	for (int i = 0; i < 100; ++i)
+	{
+		long long value = zipfArg.get_rnd();
+		ensuref((value >= 1 && value <= 1000000000000LL) || (value >= -3 && value <= -1), "zipf range_array get_rnd");
+	}
+	// rank frequencies of zipf(1.5) are proportional to rank^-1.5, so rank 1 is about 2.8 times as frequent as rank 2
+	auto zipfRanks = arguments::impl_arg_parsing::parse_range<int>("!zipf(1.5){[1,1000]}", arguments::parsing_options{});
+	int zipfCounts[3] = {};
+	for (int i = 0; i < 10000; ++i)
+	{
+		int value = zipfRanks.get_rnd();
+		if (value <= 2) ++zipfCounts[value];
+	}
+	ensuref(zipfCounts[1] > 2 * zipfCounts[2] && zipfCounts[1] < 4 * zipfCounts[2] && zipfCounts[2] > 0, "zipf rank frequencies");
+
+	const auto& cachedK = args["k"].ranges<int>();
+	ensuref(&cachedK == &args["k"].ranges<int>() && cachedK.size() == arg_k.size() && args["m"].value<int>() == 89
+		&& args["m"].value<long long>() == 89 && !args["none"] && args.has("n"), "cached arguments");
+
+	{
+		problib::impl::generator_root schemaArgs;
+		auto schemaN = schemaArgs.declare<long long>("n", "[1,1e5]");
+		auto schemaK = schemaArgs.declare_or<int>("k", "[0,10]", "{1,[2,3]}");
+		schemaArgs.init("n=[5,100000]");
+		ensuref(schemaN.ranges().total_length() == 99996 && schemaK.ranges().size() == 2, "argument schema");
+		bool rejected = false;
+		try { schemaArgs.init("n=5 extra=1"); }
+		catch (const std::invalid_argument&) { rejected = true; }
+		ensuref(rejected, "argument schema unknown argument");
+		rejected = false;
+		try { schemaArgs.init("n=0"); }
+		catch (const std::invalid_argument&) { rejected = true; }
+		ensuref(rejected, "argument schema bounds");
+	}
+
+	{
+		constexpr auto literal = parse_range_literal<int>("{1,[43,65],(2,7),33}");
+		static_assert(literal.size() == 4 && literal[1].from == 43 && literal[2].from == 3 && literal[2].to == 6, "constexpr range literal");
+		constexpr arguments::literal_parsing_options angleOptions{ "<", ">", "<=", ">=", "set(", ")", "#", "skew", "zipf", "geom", ";" };
+		constexpr auto custom = parse_range_literal<long long>("#set(1e12; <=5; 9>)", angleOptions);
+		static_assert(custom.size() == 2 && custom[0].from == 1000000000000LL && custom[1].to == 8
+			&& custom.options().random_mode == range_random_mode::uniform_by_count, "constexpr range literal options");
+		constexpr auto weightedLiteral = parse_range_literal<double>("zipf(1.25){[0.5,2.5]:3,0.1}");
+		static_assert(weightedLiteral.options().random_mode == range_random_mode::weighted && weightedLiteral.weight(0) == 3
+			&& weightedLiteral[1].from == 0.1 && weightedLiteral.options().distribution_parameter == 1.25, "constexpr weighted range literal");
+
+		range_array<int> fromLiteral = literal;
+		auto fromRuntime = arguments::impl_arg_parsing::parse_range<int>("{1,[43,65],(2,7),33}", arguments::parsing_options{});
+		ensuref(fromLiteral.size() == fromRuntime.size() && fromLiteral.total_length() == fromRuntime.total_length(), "range literal matches runtime parsing");
+		ensuref(args["none"].ranges_or(literal).size() == 4 && args["none"].ranges_or<int>(literal).size() == 4, "range literal as default");
+
+		// texts with custom brackets are not valid with the default options, so these ranges are not parsed again
+		constexpr auto compact = parse_range_literal<long long>("#set(7;<=5;9>)", angleOptions);
+		problib::impl::generator_root literalArgs;
+		auto literalDefault = literalArgs.declare_or("c", "", custom);
+		auto literalPreset = literalArgs.declare<long long>("d");
+		literalArgs.preset("d", compact);
+		literalArgs.init("d=#set(7;<=5;9>)");
+		ensuref(literalDefault.ranges().size() == 2 && literalDefault.ranges()[0].from == 1000000000000LL
+			&& literalPreset.ranges().size() == 2 && literalPreset.ranges()[0].from == 7, "range literal arguments");
+	}
+
+	{
+		random_t saved = rnd;
+		std::string generator(problib::impl::generator_name(argv[0]));
+		std::string script = generator + " n=[1,1000000] > 1\nother-gen 5 > $\n\n" + generator + " n=[1,1e18] m=2 > $\n";
+		std::FILE* scriptFile = std::fopen("problib-test-script.txt", "wb");
+		std::fputs(script.c_str(), scriptFile);
+		std::fclose(scriptFile);
+		problib::impl::generator_root batchArgs;
+		batchArgs.run(2, std::vector<const char*>{ argv[0], "--script=problib-test-script.txt" }.data(), [&]
+		{
+			io::writer out;
+			out << batchArgs["n"].ranges<long long>().get_rnd() << ' ' << batchArgs["m"].ranges_or<int>("0").get_rnd();
+		});
+
+		std::vector<const char*> standalone{ argv[0], "n=[1,1e18]", "m=2" };
+		rnd.setSeed(standalone.size(), const_cast<char**>(standalone.data()));
+		long long expected = rnd.next(1LL, 1000000000000000000LL);
+		std::string serialFirst = problib::impl::read_file("1.in");
+		ensuref(problib::impl::read_file("3.in") == std::to_string(expected) + " 2" && serialFirst.size() > 2, "generator_root run gen-script");
+
+		std::remove("1.in");
+		std::remove("3.in");
+		int parallelCode = batchArgs.run(3, std::vector<const char*>{ argv[0], "--script=problib-test-script.txt", "--jobs=2" }.data(), [&]
+		{
+			io::writer out;
+			out << batchArgs["n"].ranges<long long>().get_rnd() << ' ' << batchArgs["m"].ranges_or<int>("0").get_rnd();
+		});
+		ensuref(parallelCode == 0 && problib::impl::read_file("1.in") == serialFirst
+			&& problib::impl::read_file("3.in") == std::to_string(expected) + " 2", "generator_root run gen-script in parallel");
+
+		std::remove("1.in");
+		std::remove("3.in");
+		int workerCode = batchArgs.run(3, std::vector<const char*>{ argv[0], "--script=problib-test-script.txt", "--worker=1/2" }.data(), [&]
+		{
+			io::writer out;
+			out << batchArgs["n"].ranges<long long>().get_rnd() << ' ' << batchArgs["m"].ranges_or<int>("0").get_rnd();
+		});
+		// the other worker's test is not written
+		std::FILE* otherShare = std::fopen("1.in", "rb");
+		if (otherShare) std::fclose(otherShare);
+		ensuref(workerCode == 0 && problib::impl::read_file("3.in") == std::to_string(expected) + " 2" && !otherShare,
+			"generator_root run gen-script worker share");
+
+		// a failed test is reported the same way serially and in parallel, the other tests are still generated
+		for (const char* jobsArg : { "--jobs=1", "--jobs=2" })
+		{
+			std::remove("1.in");
+			int failedCode = batchArgs.run(3, std::vector<const char*>{ argv[0], "--script=problib-test-script.txt", jobsArg }.data(), [&]
+			{
+				if (batchArgs.has("m")) throw std::runtime_error("expected failure");
+				io::writer out;
+				out << batchArgs["n"].ranges<long long>().get_rnd();
+			});
+			ensuref(failedCode == EXIT_FAILURE && problib::impl::read_file("1.in") == serialFirst.substr(0, serialFirst.find(' ')),
+				"generator_root run gen-script failure");
+		}
+		std::remove("problib-test-script.txt");
+		std::remove("1.in");
+		std::remove("3.in");
+		rnd = saved;
+	}
+
+	{
+		random_stream base;
+		random_t stepped = base.get();
+		for (int i = 0; i < 1000; ++i) stepped.next(1 << 20);
+		for (int i = 0; i < 500; ++i) stepped.next(1LL << 40);
+		ensuref(random_stream(base).discard(2000) == random_stream(stepped), "random_stream discard");
+
+		random_stream parent = base;
+		random_stream first = parent.split();
+		ensuref(first == base && parent == base.stream(1) && base.stream(3) == random_stream(base).discard(3 * random_stream::stream_steps),
+			"random_stream split");
+
+		std::vector<long long> sequential;
+		for (int i = 0; i < 10; ++i) sequential.push_back(base.stream(i)->next(1LL, 1000000000000LL));
+		random_stream deep = base.stream(7);
+		ensuref(deep->next(1LL, 1000000000000LL) == sequential[7], "random_stream regenerate item");
+
+		random_t saved = rnd;
+		base.stream(2).make_current();
+		ensuref(make_range(1LL, 1000000000000LL).get_rnd() == sequential[2], "random_stream make_current");
+		rnd = saved;
+	}
+
+	{
+		random_t saved = rnd;
+		std::vector<std::string> expected;
+		for (int i = 0; i < 100; ++i) expected.push_back(rnd.next("[1-9][0-9]{0,5}|x[^a-y]{3}|(a|(b|c{2}))"));
+		long long after = rnd.next(1LL, 1000000000000LL);
+
+		rnd = saved;
+		compiled_pattern compiled("[1-9][0-9]{0,5}|x[^a-y]{3}|(a|(b|c{2}))");
+		auto generated = compiled.get_rnd_n(50);
+		for (int i = 0; i < 50; ++i) generated.push_back(compiled.get_rnd());
+		ensuref(generated == expected && rnd.next(1LL, 1000000000000LL) == after, "compiled_pattern");
+
+		compiled_pattern greedy("[a-c]{0,2}[b-d]{1,2}|(a|ab)");
+		pattern reference(greedy.src());
+		for (std::string s : { "", "a", "ab", "abd", "bb", "bbb", "ccd", "abcd", "ba" }) ensuref(greedy.matches(s) == reference.matches(s), "compiled_pattern matches");
+		ensuref(compiled_pattern("[a-z]{1,200000}").matches(std::string(200000, 'z')) && !compiled_pattern("[a-z]{1,200000}").matches(std::string(200001, 'z')),
+			"compiled_pattern matches long token");
+		// the texts of testlib InStream::readWord and InStream::readStringTo
+		ensuref(problib::impl::pattern_mismatch_message("Token", InStream::NO_INDEX, "ab", greedy, "x")
+				== "Token parameter [name=x] equals to \"ab\", doesn't correspond to pattern \"[a-c]{0,2}[b-d]{1,2}|(a|ab)\""
+			&& problib::impl::pattern_mismatch_message("Line", InStream::NO_INDEX, "ab", greedy, "x")
+				== "Line [name=x] equals to \"ab\", doesn't correspond to pattern \"[a-c]{0,2}[b-d]{1,2}|(a|ab)\""
+			&& problib::impl::pattern_mismatch_message("Token", 3, "ab", greedy, "x")
+				== "Token element x[3] equals to \"ab\", doesn't correspond to pattern \"[a-c]{0,2}[b-d]{1,2}|(a|ab)\""
+			&& problib::impl::pattern_mismatch_message("Token", InStream::NO_INDEX, "ab", greedy, "")
+				== "Token \"ab\" doesn't correspond to pattern \"[a-c]{0,2}[b-d]{1,2}|(a|ab)\"",
+			"pattern mismatch message");
+		rnd = saved;
+	}
+
+	{
+		// returns max degree, or -1 if the edges are not a tree
+		auto treeDegree = [](const gen::tree& t)
+		{
+			int n = t.vertex_count();
+			std::vector<int> degree(n), leader(n);
+			std::iota(leader.begin(), leader.end(), 0);
+			auto find = [&](int v) { while (leader[v] != v) v = leader[v] = leader[leader[v]]; return v; };
+			for (size_t i = 0; i < t.edge_count(); ++i)
+			{
+				auto [u, v] = t.edge(i);
+				if (u < 0 || v < 0 || u >= n || v >= n || find(u) == find(v)) return -1;
+				leader[find(u)] = find(v);
+				++degree[u], ++degree[v];
+			}
+			return t.edge_count() + 1 == size_t(n) ? *std::max_element(degree.begin(), degree.end()) : -1;
+		};
+		ensuref(treeDegree(gen::tree::prufer(1000)) > 0 && treeDegree(gen::tree::prufer(2)) == 1 && treeDegree(gen::tree::random_parent(1000, -3)) > 0
+			&& treeDegree(gen::tree::caterpillar(1000, 10)) > 0 && treeDegree(gen::tree::broom(1000, 500)) == 501, "tree generators");
+		ensuref(treeDegree(gen::tree::bamboo(1000)) == 2 && treeDegree(gen::tree::star(1000)) == 999, "tree generators shape");
+
+		auto canonical = gen::tree::bamboo(3, false);
+		std::string treeOut;
+		{
+			io::writer out(treeOut);
+			canonical.write(out);
+		}
+		ensuref(canonical.root() == 0 && treeOut == "2 1\n3 2\n", "tree write");
+	}
+
+	{
+		// true if the edges are distinct, without loops and connect all vertices
+		auto connectedSimple = [](const gen::graph& g, bool directed)
+		{
+			int n = g.vertex_count();
+			std::vector<int> leader(n);
+			std::iota(leader.begin(), leader.end(), 0);
+			auto find = [&](int v) { while (leader[v] != v) v = leader[v] = leader[leader[v]]; return v; };
+			std::set<std::pair<int, int>> edges;
+			int components = n;
+			for (size_t i = 0; i < g.edge_count(); ++i)
+			{
+				auto [u, v] = g.edge(i);
+				if (u < 0 || v < 0 || u >= n || v >= n || u == v) return false;
+				if (!edges.insert(directed ? std::make_pair(u, v) : std::make_pair(std::min(u, v), std::max(u, v))).second) return false;
+				if (find(u) != find(v))
+				{
+					leader[find(u)] = find(v);
+					--components;
+				}
+			}
+			return components == 1;
+		};
+
+		gen::graph_opts dagOpts;
+		dagOpts.acyclic = true;
+		gen::graph_opts directedOpts;
+		directedOpts.directed = true;
+		gen::graph_opts bipartiteOpts;
+		bipartiteOpts.left = 3;
+		// sparse and dense generation, every possible edge exactly once for the complete graphs
+		for (long long m : { 10LL, 30LL, 45LL })
+		{
+			for (const auto& opts : { gen::graph_opts(), dagOpts })
+			{
+				auto g = gen::graph::random(10, m, opts, false);
+				bool forward = true;
+				for (size_t i = 0; i < g.edge_count(); ++i) forward &= g.edge(i).first < g.edge(i).second;
+				ensuref(g.edge_count() == size_t(m) && connectedSimple(g, false) && forward, "graph random");
+			}
+		}
+		for (long long m : { 10LL, 45LL, 90LL })
+		{
+			auto g = gen::graph::random(10, m, directedOpts);
+			ensuref(g.edge_count() == size_t(m) && connectedSimple(g, true), "directed graph random");
+		}
+		// 12 and 15 of 15 possible edges are generated densely
+		for (long long m : { 8LL, 12LL, 15LL })
+		{
+			auto bipartite = gen::graph::random(8, m, bipartiteOpts, false);
+			bool crossing = true;
+			for (size_t i = 0; i < bipartite.edge_count(); ++i) crossing &= bipartite.edge(i).first < 3 && bipartite.edge(i).second >= 3;
+			ensuref(bipartite.edge_count() == size_t(m) && connectedSimple(bipartite, false) && crossing, "bipartite graph random");
+		}
+
+		std::vector<int> degrees{ 3, 1, 2, 2, 4, 1, 3 };
+		auto byDegrees = gen::graph::with_degrees(degrees, 1000, false);
+		std::vector<int> realized(degrees.size());
+		std::set<std::pair<int, int>> degreeEdges;
+		for (size_t i = 0; i < byDegrees.edge_count(); ++i)
+		{
+			auto [u, v] = byDegrees.edge(i);
+			++realized[u], ++realized[v];
+			degreeEdges.insert({ u, v });
+		}
+		ensuref(realized == degrees && degreeEdges.size() == byDegrees.edge_count()
+			&& std::all_of(degreeEdges.begin(), degreeEdges.end(), [](auto e) { return e.first < e.second; }),
+			"graph with_degrees");
+		// shuffling keeps the degree of every vertex
+		std::vector<int> shuffledDegrees(degrees.size());
+		std::set<std::pair<int, int>> shuffledEdges;
+		auto byDegreesShuffled = gen::graph::with_degrees(degrees, 1000);
+		for (size_t i = 0; i < byDegreesShuffled.edge_count(); ++i)
+		{
+			auto [u, v] = byDegreesShuffled.edge(i);
+			++shuffledDegrees[u], ++shuffledDegrees[v];
+			if (u != v) shuffledEdges.insert({ std::min(u, v), std::max(u, v) });
+		}
+		ensuref(shuffledDegrees == degrees && shuffledEdges.size() == byDegreesShuffled.edge_count(), "shuffled graph with_degrees");
+		auto regular = gen::graph::with_degrees(1000, range_array<int>(make_range(3, 3)), 10000);
+		ensuref(regular.edge_count() == 1500, "regular graph with_degrees");
+
+		std::string graphOut;
+		{
+			io::writer out(graphOut);
+			gen::graph::random(3, 3, gen::graph_opts(), false).write(out, range_array<int>(make_range(7, 7)), 0);
+		}
+		ensuref(graphOut == "0 1 7\n0 2 7\n1 2 7\n", "graph write");
+	}
+
+	ensuref(str::parse<int>(" 42 ") == 42, "int parsing");
+	ensuref(str::parse<long long>("-9223372036854775808") == LLONG_MIN, "int64 parsing");
+	ensuref(str::parse<double>("+2.5") == 2.5, "double parsing");
+	int bad;
+	ensuref(!str::try_parse("12x", bad) && !str::try_parse("99999999999", bad), "invalid int parsing");
+	ensuref(str::parse<long long>("1e18") == 1000000000000000000LL && str::parse<int>("2.5e3") == 2500 && !str::try_parse("1.5e0", bad)
+		&& !str::try_parse("1e10", bad), "int exponent parsing");
+#ifdef __SIZEOF_INT128__
+	ensuref(str::parse<__int128>("-170141183460469231731687303715884105728") == -(__int128)(((unsigned __int128)1 << 127) - 1) - 1, "int128 parsing");
+#endif
+
+	auto pieces = str::split("a, b,, c, ", ", ", true);
+	ensuref(pieces.size() == 3 && pieces[1] == "b," && pieces[2] == "c", "split");
+	size_t lazyCount = 0;
+	for (auto piece : str::split_view("abababa", "aba")) lazyCount += piece.size();
+	ensuref(lazyCount == 1, "split_view");
+
+	constexpr auto digits = str::char_class::range('0', '9');
+	std::string spaced = std::string(40, ' ') + "token\t" + std::string(40, '7');
+	ensuref(str::trim(spaced) == spaced.substr(40) && digits.find_first(spaced) == 46, "char_class");
+
 	return 0;
 }
 